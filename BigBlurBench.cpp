@@ -0,0 +1,383 @@
+//
+// Headless benchmark. Runs every implementation from 'san::impls_list' over a matrix of
+// image sizes, radii and thread counts and prints median/p95 time and throughput as CSV or JSON.
+//
+// Usage: BigBlurBench [--sizes 1280x720,1920x1080] [--radii 1,8,32] [--threads 1,4] [--iters 25] [--filter str] [--format csv|json]
+//                     [--schedule static,dynamic,guided] [--grain 4] [--image file.bgra] [--reference str] [--pixels rgba8,rgba16,rgba16f,a8]
+//
+
+#include "san_pch.hpp"
+
+#include "san_cmake_config.hpp"
+#include "san_cpu_info.hpp"
+
+#include "stb_impl.hpp"
+#include "san_surface.hpp"
+#include "san_pixel.hpp"					// 16-bit and half-float pixel types
+#include "san_transpose.hpp"
+
+#include "platform/san_platform.hpp"
+#include "san_surface_raw.hpp"				// Memory-mapped raw images
+
+#include "san_adaptor_straight_line.hpp"		// Common line adaptor
+#include "san_adaptor_sheared_line.hpp"			// Digital line of any slope
+#include "san_blur_gaussian_naive.hpp"			// Gaussian blur naive impl.
+#include "san_blur_gaussian_simd.hpp"			// SIMD gaussian blur with fixed-point kernels
+
+#include "san_blur_recursive_naive.hpp"			// ...
+#include "san_blur_recursive_simd.hpp"			// SIMD recursive blur
+
+#include "san_blur_stack_luts.hpp"				// Lookup tables common for all stack blur impls.
+
+#include "san_blur_stack_naive_calc.hpp"		// Naive stack blur impl.
+#include "san_blur_stack_naive.hpp"
+
+#include "san_blur_stack_simd_calc.hpp"			// SIMD stack blur impls.
+#include "san_blur_stack_simd_naive.hpp"
+
+#include "san_blur_stack_simd_optimized_1.hpp"	// Optimized versions with LUTs
+#include "san_blur_stack_simd_optimized_2.hpp"
+#include "san_blur_stack_simd_optimized_3.hpp"	// AVX2, two lines at once
+#include "san_blur_stack_simd_optimized_4.hpp"	// AVX-512, four lines at once
+#include "san_blur_stack_simd_tiled.hpp"		// Cache-blocked vertical pass
+#include "san_blur_stack_simd_transposed.hpp"	// Vertical pass through transposed strips
+#include "san_blur_stack_simd_fused.hpp"		// Both passes in one fork/join
+#include "san_blur_stack_simd_stream.hpp"		// Row by row streaming API
+#include "san_blur_stack_simd_batch.hpp"		// Many small images in one fork/join per pass
+#include "san_blur_stack_simd_small.hpp"		// 16-bit sums for small radii
+#include "san_blur_stack_simd_premultiplied.hpp"	// Straight alpha images, blur in premultiplied space
+#include "san_blur_stack_simd_fractional.hpp"	// Fractional radius, blend of two kernels in one pass
+#include "san_blur_stack_simd_motion.hpp"		// Directional (motion) blur along sheared lines
+
+#include "san_blur_box_simd.hpp"				// Cascaded box blurs, gaussian approximation for any radius
+#include "san_blur_sat.hpp"					// Summed-area table, per pixel variable radius blur
+#include "san_blur_pyramid.hpp"				// Downsample, blur and upsample for big radii
+#include "san_blur_roi.hpp"					// Blur of sub-rectangle with halo
+#include "san_blur_stack_simd_incremental.hpp"	// Re-blur of changed region with cached horizontal pass
+#include "san_blur_a8.hpp"					// Single-channel 8-bit blurs, 16 pixels per lane group
+
+#include "san_adaptor_agg_image.hpp"
+#include "san_parallel_for.hpp"
+
+#include "san_impls_list.hpp"
+
+#include <vector>
+#include <chrono>
+
+namespace bench {
+
+struct size_t2 {
+	int	w;
+	int	h;
+};
+
+// Format and number of components of image, 'a8' is single-channel 8-bit image.
+struct pixel_kind {
+	san::pixel_format	format;
+	int					components;
+
+	const char * name() const { return components == 1 ? "a8" : san::pixel::name( format ); }
+};
+
+struct options {
+	std::vector <size_t2>	sizes		= { { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+	std::vector <int>		radii		= { 1, 8, 32, 128, 254 };
+	std::vector <int>		threads;	// Empty means { 1, 2, 4, ..., max. threads }
+	int						iterations	= 25;
+	std::string				filter;		// Run only implementations which name contains this string
+	std::string				image;		// Raw image (see 'san_surface_raw.hpp') to blur instead of generated one
+	std::string				reference;	// Report error of every implementation against the first one which name contains this string
+	bool					json		= false;
+
+	// Source image is converted to every format, only implementations which take that format are run.
+	std::vector <pixel_kind>	pixels	= { { san::pixel_format::rgba8, 4 }, { san::pixel_format::rgba16, 4 }, { san::pixel_format::rgba16f, 4 }, { san::pixel_format::rgba8, 1 } };
+
+	using schedule_e = san::parallel_for::schedule_e;
+	std::vector <schedule_e>	schedules	= { schedule_e::static_split };
+	int						grain		= 4;		// Items (rows/columns) per chunk for dynamic schedules
+};
+
+static const char * schedule_name( san::parallel_for::schedule_e schedule ) {
+	switch ( schedule ) {
+		case san::parallel_for::schedule_e::dynamic:	return "dynamic";
+		case san::parallel_for::schedule_e::guided:		return "guided";
+		default:										return "static";
+	}
+}
+
+struct result {
+	std::string	name;
+	const char *pixel;
+	int			width;
+	int			height;
+	int			radius;
+	int			threads;
+	const char *schedule;
+	int			iterations;
+	double		median_ms;
+	double		p95_ms;
+	double		mpix_s;
+	bool		has_error;
+	san::pixel::error_stats	error;
+};
+
+// Splits "a,b,c" and converts every item with 'conv'. Returns false on empty or malformed items.
+template <typename T, typename ConvT>
+static bool parse_list( const char * str, std::vector <T> & out, ConvT && conv ) {
+	out.clear();
+	std::string s( str );
+	size_t pos = 0;
+	while ( pos <= s.size() ) {
+		size_t end = s.find( ',', pos );
+		if ( end == std::string::npos ) end = s.size();
+		T value;
+		if ( !conv( s.substr( pos, end - pos ), value ) ) return false;
+		out.push_back( value );
+		pos = end + 1;
+	}
+	return !out.empty();
+}
+
+static bool to_int( const std::string & s, int & value ) {
+	char * end = nullptr;
+	long v = std::strtol( s.c_str(), &end, 10 );
+	if ( s.empty() || *end != '\0' || v <= 0 ) return false;
+	value = int(v);
+	return true;
+}
+
+static bool to_schedule( const std::string & s, san::parallel_for::schedule_e & value ) {
+	for ( auto schedule : { san::parallel_for::schedule_e::static_split, san::parallel_for::schedule_e::dynamic, san::parallel_for::schedule_e::guided } ) {
+		if ( s == schedule_name( schedule ) ) {
+			value = schedule;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool to_pixel_kind( const std::string & s, pixel_kind & value ) {
+	if ( s == "a8" ) {
+		value = { san::pixel_format::rgba8, 1 };
+		return true;
+	}
+	value.components = 4;
+	return san::pixel::from_name( s, value.format );
+}
+
+static bool to_size( const std::string & s, size_t2 & value ) {
+	size_t x = s.find( 'x' );
+	if ( x == std::string::npos ) return false;
+	return to_int( s.substr( 0, x ), value.w ) && to_int( s.substr( x + 1 ), value.h );
+}
+
+static bool parse_args( int argc, char * argv[], options & opts ) {
+	for ( int i = 1; i < argc; i++ ) {
+		std::string arg( argv[i] );
+		const char * value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		bool ok = false;
+		if ( !value ) {
+			std::fprintf( stderr, "Missing value for '%s'.\n", arg.c_str() );
+			return false;
+		} else if ( arg == "--sizes" ) {
+			ok = parse_list( value, opts.sizes, to_size );
+		} else if ( arg == "--radii" ) {
+			ok = parse_list( value, opts.radii, to_int );
+		} else if ( arg == "--threads" ) {
+			ok = parse_list( value, opts.threads, to_int );
+		} else if ( arg == "--schedule" ) {
+			ok = parse_list( value, opts.schedules, to_schedule );
+		} else if ( arg == "--grain" ) {
+			ok = to_int( value, opts.grain );
+		} else if ( arg == "--iters" ) {
+			ok = to_int( value, opts.iterations );
+		} else if ( arg == "--image" ) {
+			opts.image = value;
+			ok = true;
+		} else if ( arg == "--reference" ) {
+			opts.reference = value;
+			ok = true;
+		} else if ( arg == "--pixels" ) {
+			ok = parse_list( value, opts.pixels, to_pixel_kind );
+		} else if ( arg == "--filter" ) {
+			opts.filter = value;
+			ok = true;
+		} else if ( arg == "--format" ) {
+			opts.json = std::string( value ) == "json";
+			ok = opts.json || std::string( value ) == "csv";
+		} else {
+			std::fprintf( stderr, "Unknown option '%s'.\n", arg.c_str() );
+			return false;
+		}
+
+		if ( !ok ) {
+			std::fprintf( stderr, "Bad value '%s' for '%s'.\n", value, arg.c_str() );
+			return false;
+		}
+		i++;
+	}
+	return true;
+}
+
+// Nearest-rank percentile of already sorted samples
+static double percentile( const std::vector <double> & sorted, double p ) {
+	size_t i = size_t( std::ceil( p / 100. * sorted.size() ) );
+	return sorted[i > 0 ? i - 1 : 0];
+}
+
+static void print_csv( const std::vector <result> & results ) {
+	std::printf( "impl,pixel,width,height,radius,threads,schedule,iterations,median_ms,p95_ms,mpix_s,max_err,mean_err,psnr_db\n" );
+	for ( const result & r : results ) {
+		std::printf( "\"%s\",%s,%d,%d,%d,%d,%s,%d,%.4f,%.4f,%.1f",
+			r.name.c_str(), r.pixel, r.width, r.height, r.radius, r.threads, r.schedule, r.iterations, r.median_ms, r.p95_ms, r.mpix_s );
+		if ( r.has_error ) {
+			std::printf( ",%.6g,%.4g,%.2f\n", r.error.max_abs, r.error.mean_abs, r.error.psnr_db );
+		} else {
+			std::printf( ",,,\n" );
+		}
+	}
+}
+
+static void print_json( const std::vector <result> & results, const san::cpu_info & cpu_info ) {
+	std::printf( "{\n" );
+	std::printf( "  \"cpu\": \"%s\",\n", cpu_info.brand().c_str() );
+	std::printf( "  \"cpu_features\": \"%s\",\n", cpu_info.feats().c_str() );
+	std::printf( "  \"compiler\": \"%s\",\n", san::cmake::compiler_id().c_str() );
+	std::printf( "  \"build_type\": \"%s\",\n", san::cmake::build_type().c_str() );
+	std::printf( "  \"results\": [\n" );
+	for ( size_t i = 0; i < results.size(); i++ ) {
+		const result & r = results[i];
+		std::printf( "    { \"impl\": \"%s\", \"pixel\": \"%s\", \"width\": %d, \"height\": %d, \"radius\": %d, \"threads\": %d, \"schedule\": \"%s\", \"iterations\": %d, "
+					 "\"median_ms\": %.4f, \"p95_ms\": %.4f, \"mpix_s\": %.1f",
+			r.name.c_str(), r.pixel, r.width, r.height, r.radius, r.threads, r.schedule, r.iterations, r.median_ms, r.p95_ms, r.mpix_s );
+		if ( r.has_error ) {
+			// JSON has no infinity, equal images have 'null' PSNR.
+			std::printf( ", \"max_err\": %.6g, \"mean_err\": %.4g, \"psnr_db\": ", r.error.max_abs, r.error.mean_abs );
+			if ( std::isfinite( r.error.psnr_db ) ) std::printf( "%.2f", r.error.psnr_db ); else std::printf( "null" );
+		}
+		std::printf( " }%s\n", i + 1 < results.size() ? "," : "" );
+	}
+	std::printf( "  ]\n}\n" );
+}
+
+} // namespace bench
+
+int main( int argc, char * argv[] ) {
+	bench::options opts;
+	if ( !bench::parse_args( argc, argv, opts ) ) return 1;
+
+	san::cpu_info		cpu_info;
+	san::parallel_for	parallel_for;
+
+	if ( opts.threads.empty() ) {
+		for ( int n = 1; n < parallel_for.num_threads(); n *= 2 ) opts.threads.push_back( n );
+		opts.threads.push_back( parallel_for.num_threads() );
+	}
+
+	std::fprintf( stderr, "CPU: %s (%s), pool threads: %d\n", cpu_info.brand().c_str(), cpu_info.feats().c_str(), parallel_for.num_threads() );
+
+	using impl_func_t = std::function <void(float, int)>;
+	using clock_t = std::chrono::steady_clock;
+
+	std::vector <bench::result> results;
+
+	// Mapped copy-on-write, file isn't changed.
+	std::shared_ptr <san::surface> p_image;
+	if ( !opts.image.empty() ) {
+		p_image = san::map_raw_image( opts.image.c_str() );
+		if ( !p_image ) return 1;
+		opts.sizes = { { p_image->width(), p_image->height() } };
+	}
+
+	for ( const bench::size_t2 & size : opts.sizes ) {
+
+		// Blur result doesn't depend on content much, but keep it non-uniform anyway.
+		san::surface source_8( size.w, size.h, 4 );
+		if ( p_image ) {
+			p_image->blit_to( source_8 );
+		} else {
+			for ( int y = 0; y < source_8.height(); y++ ) {
+				uint32_t * p = reinterpret_cast<uint32_t *>( source_8.row_ptr( y ) );
+				for ( int x = 0; x < source_8.width(); x++ ) {
+					p[x] = ((x >> 6) + (y >> 6)) & 1 ? 0xffffffff : uint32_t(x * 2654435761u ^ y * 40503u);
+				}
+			}
+		}
+
+		for ( const bench::pixel_kind & pixel : opts.pixels ) {
+			san::surface source( size.w, size.h, pixel.components, pixel.format );
+			if ( !san::pixel::convert( source_8, source ) ) continue;
+
+			san::surface			work( size.w, size.h, pixel.components, pixel.format );
+			san::surface_view		view_san( work );
+			san::adaptor::agg_image	view_agg( view_san );
+			san::impls_list <impl_func_t> impls( cpu_info, view_san, view_agg, parallel_for );
+
+			// Output of reference implementation for every radius.
+			std::vector <std::unique_ptr <san::surface>> references;
+			if ( !opts.reference.empty() ) {
+				auto it = std::find_if( impls.begin(), impls.end(), [&]( const auto & impl ) { return impl.first.find( opts.reference ) != std::string::npos; } );
+				if ( it == impls.end() ) {
+					std::fprintf( stderr, "No reference implementation '%s' for %s pixels.\n", opts.reference.c_str(), pixel.name() );
+					if ( pixel.format == san::pixel_format::rgba8 && pixel.components == 4 ) return 1;
+				} else {
+					std::fprintf( stderr, "Reference (%s): %s\n", pixel.name(), it->first.c_str() );
+				}
+
+				for ( int radius : opts.radii ) {
+					if ( it == impls.end() ) break;
+					source.blit_to( work );
+					it->second( float(radius), 0 );
+					references.emplace_back( new (std::nothrow) san::surface( work ) );
+				}
+			}
+
+			for ( const auto & impl : impls ) {
+				if ( !opts.filter.empty() && impl.first.find( opts.filter ) == std::string::npos ) continue;
+
+				for ( size_t i_radius = 0; i_radius < opts.radii.size(); i_radius++ ) {
+					int radius = opts.radii[i_radius];
+					for ( int n_threads : opts.threads ) {
+						for ( auto schedule : opts.schedules ) {
+							parallel_for.set_schedule( schedule, opts.grain );
+							std::fprintf( stderr, "%dx%d %s r=%d t=%d %s: %s\n", size.w, size.h, pixel.name(), radius, n_threads, bench::schedule_name( schedule ), impl.first.c_str() );
+
+							std::vector <double> samples;
+							samples.reserve( opts.iterations );
+
+							// One warm-up run, then timed runs. Each run starts from the same source image.
+							for ( int i = -1; i < opts.iterations; i++ ) {
+								source.blit_to( work );
+								clock_t::time_point start = clock_t::now();
+								impl.second( float(radius), n_threads );
+								double ms = std::chrono::duration<double, std::milli>( clock_t::now() - start ).count();
+								if ( i >= 0 ) samples.push_back( ms );
+							}
+
+							std::sort( samples.begin(), samples.end() );
+							double median = bench::percentile( samples, 50 );
+							results.push_back( {
+								impl.first, pixel.name(), size.w, size.h, radius, n_threads, bench::schedule_name( schedule ), opts.iterations,
+								median, bench::percentile( samples, 95 ),
+								median > 0 ? double(size.w) * size.h / (median * 1e3) : 0, false, {} } );
+
+							// 'work' has result of the last run.
+							if ( !references.empty() && references[i_radius] && *references[i_radius] ) {
+								results.back().has_error = true;
+								results.back().error = san::pixel::measure_error( *references[i_radius], work );
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if ( opts.json ) {
+		bench::print_json( results, cpu_info );
+	} else {
+		bench::print_csv( results );
+	}
+	return 0;
+}
@@ -6,18 +6,24 @@
 
 #include "stb_impl.hpp"
 #include "san_surface.hpp"
+#include "san_pixel.hpp"					// 16-bit and half-float pixel types
+#include "san_transpose.hpp"
 
 
 #include "platform/san_platform.hpp"
+#include "san_surface_raw.hpp"				// Memory-mapped raw images
 
 #ifdef SAN_PLATFORM_WINDOWS
  #include "platform/san_window_win32.hpp"
 #endif
 
 #include "san_adaptor_straight_line.hpp"		// Common line adaptor
+#include "san_adaptor_sheared_line.hpp"			// Digital line of any slope
 #include "san_blur_gaussian_naive.hpp"			// Gaussian blur naive impl.
+#include "san_blur_gaussian_simd.hpp"			// SIMD gaussian blur with fixed-point kernels
 
 #include "san_blur_recursive_naive.hpp"			// ...
+#include "san_blur_recursive_simd.hpp"			// SIMD recursive blur
 
 #include "san_blur_stack_luts.hpp"				// Lookup tables common for all stack blur impls.
 
@@ -29,6 +35,24 @@
 
 #include "san_blur_stack_simd_optimized_1.hpp"	// Optimized versions with LUTs
 #include "san_blur_stack_simd_optimized_2.hpp"
+#include "san_blur_stack_simd_optimized_3.hpp"	// AVX2, two lines at once
+#include "san_blur_stack_simd_optimized_4.hpp"	// AVX-512, four lines at once
+#include "san_blur_stack_simd_tiled.hpp"		// Cache-blocked vertical pass
+#include "san_blur_stack_simd_transposed.hpp"	// Vertical pass through transposed strips
+#include "san_blur_stack_simd_fused.hpp"		// Both passes in one fork/join
+#include "san_blur_stack_simd_stream.hpp"		// Row by row streaming API
+#include "san_blur_stack_simd_batch.hpp"		// Many small images in one fork/join per pass
+#include "san_blur_stack_simd_small.hpp"		// 16-bit sums for small radii
+#include "san_blur_stack_simd_premultiplied.hpp"	// Straight alpha images, blur in premultiplied space
+#include "san_blur_stack_simd_fractional.hpp"	// Fractional radius, blend of two kernels in one pass
+#include "san_blur_stack_simd_motion.hpp"		// Directional (motion) blur along sheared lines
+
+#include "san_blur_box_simd.hpp"				// Cascaded box blurs, gaussian approximation for any radius
+#include "san_blur_sat.hpp"					// Summed-area table, per pixel variable radius blur
+#include "san_blur_pyramid.hpp"				// Downsample, blur and upsample for big radii
+#include "san_blur_roi.hpp"					// Blur of sub-rectangle with halo
+#include "san_blur_stack_simd_incremental.hpp"	// Re-blur of changed region with cached horizontal pass
+#include "san_blur_a8.hpp"					// Single-channel 8-bit blurs, 16 pixels per lane group
 
 #include "san_adaptor_agg_image.hpp"
 #include "san_parallel_for.hpp"
@@ -37,6 +37,11 @@
 #elif defined( __linux__ )
  #define SAN_PLATFORM_LINUX
 
+ #include <fcntl.h>				// open
+ #include <unistd.h>			// close, ftruncate
+ #include <sys/mman.h>			// mmap
+ #include <sys/stat.h>			// fstat
+
 #else
  #error "Unknown or unsupported platform."
 #endif
@@ -60,6 +65,14 @@
  #define SAN_UNLIKELY( ... )	( __VA_ARGS__ )
 #endif
 
+// Enables instruction set for single function, so the rest of the code doesn't require it.
+// MSC doesn't need it, its' intrinsics are always available.
+#if defined( SAN_COMPILER_GNU ) || defined( SAN_COMPILER_CLANG )
+ #define SAN_TARGET_AVX512	__attribute__(( target( "avx512f,avx512bw" ) ))
+#else
+ #define SAN_TARGET_AVX512
+#endif
+
 
 #if defined( SAN_COMPILER_MSC )
 
@@ -24,22 +24,22 @@ public:
 		, m_w( m_image.width() )
 		, m_h( m_image.height() ) {}
 
-// May be useful in future...
-#if 0
-	// Bound surface inside surface
-	agg_image_adaptor( sdl::surface & p_surface, int x, int y, int w, int h ) :
-		m_surface( p_surface ),
-		m_x( x ), m_y( y ), m_w( w ), m_h( h )
+	// Bound surface inside surface, AGG blurs see only this rectangle (clipped by image bounds).
+	// Rectangle which misses the image becomes empty one.
+	agg_image( surface_view & iv, int x, int y, int w, int h )
+		: m_image( iv )
+		, m_x( x ), m_y( y ), m_w( w ), m_h( h )
 	{
 		if ( m_x < 0 ) { m_w += m_x; m_x = 0; }
 		if ( m_y < 0 ) { m_h += m_y; m_y = 0; }
 
-		/*if ( m_x < 0 ) m_x = 0; else*/ if ( m_x >= m_surface.get_width()  ) m_x = m_surface.get_width()  - 1;
-		/*if ( m_y < 0 ) m_y = 0; else*/ if ( m_y >= m_surface.get_height() ) m_y = m_surface.get_height() - 1;
-		if ( m_w < 0 ) m_w = 0; else if ( m_x + m_w > m_surface.get_width()  ) m_w = m_surface.get_width()  - m_x;
-		if ( m_h < 0 ) m_h = 0; else if ( m_y + m_h > m_surface.get_height() ) m_h = m_surface.get_height() - m_y;
+		if ( m_x >= m_image.width() || m_y >= m_image.height() || m_w <= 0 || m_h <= 0 ) {
+			m_x = m_y = m_w = m_h = 0;
+			return;
+		}
+		if ( m_x + m_w > m_image.width()  ) m_w = m_image.width()  - m_x;
+		if ( m_y + m_h > m_image.height() ) m_h = m_image.height() - m_y;
 	}
-#endif
 
 	int width()  const { return m_w; }
 	int height() const { return m_h; }
@@ -53,15 +53,16 @@ public:
 		return ::agg::argb8_packed( *reinterpret_cast<uint32_t *>( m_image.pix_ptr( m_x + x, m_y + y ) ) );
 	}
 
-	value_type * row_ptr( int /*x*/, int y, unsigned /*len*/ ) const { 
-		return m_image.row_ptr( y );
+	// Begin of row 'y' of the rectangle
+	value_type * row_ptr( int /*x*/, int y, unsigned /*len*/ ) const {
+		return m_image.pix_ptr( m_x, m_y + y );
 	}
 
 	void copy_color_hspan( int x, int y, unsigned len, const color_type * colors ) const {
 		x += m_x;
 		y += m_y;
 
-		value_type * p = row_ptr( x, y, len ) + x * 4;
+		value_type * p = m_image.pix_ptr( x, y );
 		do {
 			p[order_type::R] = colors->r;
 			p[order_type::G] = colors->g;
@@ -0,0 +1,46 @@
+#pragma once
+
+namespace san::adaptor {
+
+// Digital line of constant slope (sheared line), same interface as 'basic_straight_line'.
+// Pixel 'i' of line is 'p_base[shift + p_offs[i]]': 'p_offs' - offsets of pixels from line origin along the major axis
+// (one pixel per step) plus rounded offsets along the minor one, 'shift' - offset of line origin across the lines.
+// Parallel lines share 'p_offs', so every pixel of image belongs to exactly one of them.
+template <typename PixelT>
+class basic_sheared_line {
+	PixelT *			m_base;
+	ptrdiff_t			m_shift;
+	const ptrdiff_t *	m_offs;
+	int					m_len;
+	int					m_next = 0;
+
+public:
+	using pixel_type = PixelT;
+
+	basic_sheared_line( PixelT * p_base, ptrdiff_t shift, const ptrdiff_t * p_offs, int len ) :
+		m_base( p_base ), m_shift( shift ), m_offs( p_offs ), m_len( len ) {}
+
+	int length() const { return m_len; }
+
+	PixelT get_pix( int i ) const {
+		if ( i < 0 ) i = 0; else if ( i >= m_len ) i = m_len - 1;
+		return m_base[m_shift + m_offs[i]];
+	}
+
+	void set_pix( int i, PixelT value ) {
+		m_base[m_shift + m_offs[i]] = value;
+	}
+
+	void set_pix_start( int i ) {
+		m_next = i;
+	}
+
+	void set_pix_next( PixelT value ) {
+		set_pix( m_next++, value );
+	}
+}; // class basic_sheared_line
+
+// 32-bpp line
+using sheared_line = basic_sheared_line <uint32_t>;
+
+} // namespace san::adaptor
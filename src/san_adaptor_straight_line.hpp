@@ -2,26 +2,29 @@
 
 namespace san::adaptor {
 
-// 32-bpp horizontal or vertical line adaptor
-class straight_line {
-	uint32_t *	m_ptr;
-	uint32_t *	m_ptr_start;
+// Horizontal or vertical line adaptor, 'PixelT' - pixel type (see 'san_pixel.hpp')
+template <typename PixelT>
+class basic_straight_line {
+	PixelT *	m_ptr;
+	PixelT *	m_ptr_start;
 	int			m_len;
 	int			m_advance;
 
 public:
-	straight_line( uint32_t * p_src, int len, int advance ) :
+	using pixel_type = PixelT;
+
+	basic_straight_line( PixelT * p_src, int len, int advance ) :
 		m_ptr( p_src ), m_len( len ), m_advance( advance ) {}
 
-	uint32_t *	ptr()			{ return m_ptr; }
+	PixelT *	ptr()			{ return m_ptr; }
 	int			advance() const	{ return m_advance; }
 
-	uint32_t get_pix( int i ) const {
+	PixelT get_pix( int i ) const {
 		if ( i < 0 ) i = 0; else if ( i >= m_len ) i = m_len - 1;
 		return m_ptr[i * m_advance];
 	}
 
-	void set_pix( int i, uint32_t value ) {
+	void set_pix( int i, PixelT value ) {
 		m_ptr[i * m_advance] = value;
 	}
 
@@ -32,10 +35,13 @@ public:
 		m_ptr_start = m_ptr + i * m_advance;
 	}
 
-	void set_pix_next( uint32_t value ) {
+	void set_pix_next( PixelT value ) {
 		*m_ptr_start = value;
 		m_ptr_start += m_advance;
 	}
-}; // class straight_line
+}; // class basic_straight_line
+
+// 32-bpp line
+using straight_line = basic_straight_line <uint32_t>;
 
 } // namespace san::adaptor
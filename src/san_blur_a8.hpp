@@ -0,0 +1,351 @@
+#pragma once
+
+namespace san::blur::a8 {
+
+// Blurs of single-channel 8-bit images (A8 masks, grayscale): 'san::surface( w, h, 1 )'.
+// 16 adjacent pixels per lane group with 32-bit sums, each of them is a pixel of its own line:
+//  - vertical pass walks 16 adjacent columns row by row (one 16 bytes load per row);
+//  - horizontal pass transposes strip of 16 rows to scratch buffer, walks it the same way and transposes it back.
+// Lane group type ('LaneT') holds 16 sums, 4 per SSE register or 8 per AVX2 one:
+//  'sse128_u32x16_t' - four SSE registers (SSE4.1);
+//  'avx256_u32x16_t' - two AVX2 registers.
+
+class sse128_u32x16_t {
+	__m128i	m_v[4];
+
+public:
+	sse128_u32x16_t() : m_v{ _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() } {}
+
+	// 16 pixels
+	explicit sse128_u32x16_t( __m128i bytes ) {
+		m_v[0] = _mm_cvtepu8_epi32( bytes );
+		m_v[1] = _mm_cvtepu8_epi32( _mm_srli_si128( bytes,  4 ) );
+		m_v[2] = _mm_cvtepu8_epi32( _mm_srli_si128( bytes,  8 ) );
+		m_v[3] = _mm_cvtepu8_epi32( _mm_srli_si128( bytes, 12 ) );
+	}
+
+	static sse128_u32x16_t splat( uint32_t v ) {
+		sse128_u32x16_t r;
+		for ( auto & x : r.m_v ) x = _mm_set1_epi32( v );
+		return r;
+	}
+
+	// Saturated 16 pixels
+	__m128i bytes() const {
+		return _mm_packus_epi16( _mm_packus_epi32( m_v[0], m_v[1] ), _mm_packus_epi32( m_v[2], m_v[3] ) );
+	}
+
+	sse128_u32x16_t & operator += ( const sse128_u32x16_t & rhs ) {
+		for ( int i = 0; i < 4; i++ ) m_v[i] = _mm_add_epi32( m_v[i], rhs.m_v[i] );
+		return *this;
+	}
+
+	sse128_u32x16_t & operator -= ( const sse128_u32x16_t & rhs ) {
+		for ( int i = 0; i < 4; i++ ) m_v[i] = _mm_sub_epi32( m_v[i], rhs.m_v[i] );
+		return *this;
+	}
+
+	sse128_u32x16_t operator * ( uint32_t rhs ) const {
+		sse128_u32x16_t r;
+		const __m128i m = _mm_set1_epi32( rhs );
+		for ( int i = 0; i < 4; i++ ) r.m_v[i] = _mm_mullo_epi32( m_v[i], m );
+		return r;
+	}
+
+	sse128_u32x16_t operator >> ( uint8_t rhs ) const {
+		sse128_u32x16_t r;
+		const __m128i n = _mm_cvtsi32_si128( rhs );
+		for ( int i = 0; i < 4; i++ ) r.m_v[i] = _mm_srl_epi32( m_v[i], n );
+		return r;
+	}
+}; // class sse128_u32x16_t
+
+#if defined( __AVX2__ )
+
+class avx256_u32x16_t {
+	__m256i	m_lo;
+	__m256i	m_hi;
+
+public:
+	avx256_u32x16_t() : m_lo( _mm256_setzero_si256() ), m_hi( _mm256_setzero_si256() ) {}
+
+	explicit avx256_u32x16_t( __m128i bytes )
+		: m_lo( _mm256_cvtepu8_epi32( bytes ) )
+		, m_hi( _mm256_cvtepu8_epi32( _mm_srli_si128( bytes, 8 ) ) ) {}
+
+	static avx256_u32x16_t splat( uint32_t v ) {
+		avx256_u32x16_t r;
+		r.m_lo = r.m_hi = _mm256_set1_epi32( v );
+		return r;
+	}
+
+	__m128i bytes() const {
+		// 'packus' works within 128-bit lanes: 0-3, 8-11 | 4-7, 12-15, so 64-bit quarters are reordered.
+		__m256i w = _mm256_permute4x64_epi64( _mm256_packus_epi32( m_lo, m_hi ), 0xd8 );
+		return _mm_packus_epi16( _mm256_castsi256_si128( w ), _mm256_extracti128_si256( w, 1 ) );
+	}
+
+	avx256_u32x16_t & operator += ( const avx256_u32x16_t & rhs ) {
+		m_lo = _mm256_add_epi32( m_lo, rhs.m_lo );
+		m_hi = _mm256_add_epi32( m_hi, rhs.m_hi );
+		return *this;
+	}
+
+	avx256_u32x16_t & operator -= ( const avx256_u32x16_t & rhs ) {
+		m_lo = _mm256_sub_epi32( m_lo, rhs.m_lo );
+		m_hi = _mm256_sub_epi32( m_hi, rhs.m_hi );
+		return *this;
+	}
+
+	avx256_u32x16_t operator * ( uint32_t rhs ) const {
+		avx256_u32x16_t r;
+		const __m256i m = _mm256_set1_epi32( rhs );
+		r.m_lo = _mm256_mullo_epi32( m_lo, m );
+		r.m_hi = _mm256_mullo_epi32( m_hi, m );
+		return r;
+	}
+
+	avx256_u32x16_t operator >> ( uint8_t rhs ) const {
+		avx256_u32x16_t r;
+		const __m128i n = _mm_cvtsi32_si128( rhs );
+		r.m_lo = _mm256_srl_epi32( m_lo, n );
+		r.m_hi = _mm256_srl_epi32( m_hi, n );
+		return r;
+	}
+}; // class avx256_u32x16_t
+
+#endif // defined( __AVX2__ )
+
+
+// Runs 'do_lines( p, len, advance, p_scratch )' over all rows, then over all columns of 'image', 16 lines at once:
+// pixel 'i' of line 'k' is 'p[i * advance + k]'. 'p_scratch' - 'scratch_size' vectors owned by thread.
+template <typename ImageViewT, typename ParallelForT, typename LinesF>
+void for_each_lines( ImageViewT & image, ParallelForT & parallel_for, int override_num_threads, size_t scratch_size, LinesF && do_lines ) {
+	assert( image.components() == 1 && image.format() == san::pixel_format::rgba8 );
+
+	const int w = image.width();
+	const int h = image.height();
+	const int stride = image.stride();
+
+	// Horizontal pass (strips of 16 rows through transposed buffer)...
+	parallel_for.run_and_wait( 0, (h + 15) / 16, [&]( int a, int b ) {
+		__m128i * buf = new (std::nothrow) __m128i [size_t(w) + scratch_size];
+		if ( !buf ) {
+			std::fprintf( stderr, "%s: couldn't allocate strip buffer.\n", __FUNCTION__ );
+			return;
+		}
+
+		uint8_t * p_strip = (uint8_t *)buf;
+		for ( int i = a; i < b; i++ ) {
+			int rows = std::min( 16, h - i * 16 );
+			uint8_t * p_row = image.row_ptr( i * 16 );
+
+			// Missing rows of the last strip are zeros, they aren't written back.
+			if ( rows < 16 ) std::fill( buf, buf + w, _mm_setzero_si128() );
+
+			san::transpose( p_row, stride, p_strip, 16, w, rows );
+			do_lines( p_strip, w, 16, buf + w );
+			san::transpose( p_strip, 16, p_row, stride, rows, w );
+		}
+		delete [] buf;
+	}, override_num_threads );
+
+	// Vertical pass (strips of 16 columns in place, the last one through buffer)...
+	parallel_for.run_and_wait( 0, (w + 15) / 16, [&]( int a, int b ) {
+		__m128i * buf = new (std::nothrow) __m128i [size_t(h) + scratch_size];
+		if ( !buf ) {
+			std::fprintf( stderr, "%s: couldn't allocate strip buffer.\n", __FUNCTION__ );
+			return;
+		}
+
+		for ( int i = a; i < b; i++ ) {
+			int cols = std::min( 16, w - i * 16 );
+			uint8_t * p_col = image.col_ptr( i * 16 );
+
+			if ( cols == 16 ) {
+				do_lines( p_col, h, stride, buf + h );
+				continue;
+			}
+
+			uint8_t * p_strip = (uint8_t *)buf;
+			std::fill( buf, buf + h, _mm_setzero_si128() );
+			for ( int y = 0; y < h; y++ ) std::memcpy( p_strip + y * 16, p_col + size_t(y) * stride, cols );
+			do_lines( p_strip, h, 16, buf + h );
+			for ( int y = 0; y < h; y++ ) std::memcpy( p_col + size_t(y) * stride, p_strip + y * 16, cols );
+		}
+		delete [] buf;
+	}, override_num_threads );
+}
+
+
+// Stack blur, the same result as 'stack::naive' of 8-bit channel.
+template <typename LaneT>
+class stack {
+	int			m_radius;
+	int			m_div;
+	uint32_t	m_mul;
+	uint8_t		m_shr;
+
+	static __m128i load( const uint8_t * p ) { return _mm_loadu_si128( (const __m128i *)p ); }
+
+	// p_stack - 'm_div' vectors
+	void do_lines( uint8_t * __restrict p_line, int len, int advance, __m128i * __restrict p_stack ) const {
+		const int radius = m_radius;
+		const int div    = m_div;
+
+		LaneT sum, sum_in, sum_out;
+
+		// Accum. left part of stacks (border color)...
+		{
+			int n = radius + 1;
+			__m128i v = load( p_line );
+			for ( int i = 0; i <= radius; i++ ) p_stack[i] = v;
+			sum     = LaneT( v ) * ((n * (n + 1)) >> 1);
+			sum_out = LaneT( v ) * n;
+		}
+
+		// Accum. right part of stacks...
+		{
+			uint8_t * p_src = p_line;
+			int j = radius;
+			for ( int i = 1; i <= radius; i++, j-- ) {
+				if ( SAN_LIKELY( i < len ) ) p_src += advance;
+				__m128i v = load( p_src );
+				p_stack[radius + i] = v;
+				sum    += LaneT( v ) * j;
+				sum_in += LaneT( v );
+			}
+		}
+
+		// Lines not longer than radius have no pixels inside, all the rest reads the border pixel.
+		const int n_inner = std::max( len - (radius + 1), 0 );
+
+		int i_stack = radius;
+		uint8_t * p_src = p_line + advance * std::min( radius + 1, len - 1 );
+		uint8_t * p_dst = p_line;
+		int n = n_inner;
+
+		// Pixels inside line, then border pixel.
+		for ( int border = 0; border < 2; border++ ) {
+			if ( border ) {
+				p_src = p_line + advance * (len - 1);
+				n = len - n_inner;
+			}
+
+			while ( n-- > 0 ) {
+				_mm_storeu_si128( (__m128i *)p_dst, (sum * m_mul >> m_shr).bytes() );
+				sum -= sum_out;
+
+				int stack_start = i_stack + div - radius;
+				if ( stack_start >= div ) stack_start -= div;
+				sum_out -= LaneT( p_stack[stack_start] );
+
+				__m128i v = load( p_src );
+				p_stack[stack_start] = v;
+				sum_in += LaneT( v );
+				sum    += sum_in;
+
+				if ( ++i_stack >= div ) i_stack = 0;
+
+				LaneT vn( p_stack[i_stack] );
+				sum_out += vn;
+				sum_in  -= vn;
+
+				if ( !border ) p_src += advance;
+				p_dst += advance;
+			}
+		}
+	}
+
+public:
+	// 'sum * mul' must fit in 32 bits
+	static constexpr int max_radius = 254;
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( radius < 1 ) return;
+		m_radius = std::min( radius, max_radius );
+		m_div    = m_radius * 2 + 1;
+		m_mul    = san::blur::stack::lut_mul[m_radius];
+		m_shr    = san::blur::stack::lut_shr[m_radius];
+
+		for_each_lines( image, parallel_for, override_num_threads, m_div, [this]( uint8_t * p, int len, int advance, __m128i * p_scratch ) {
+			do_lines( p, len, advance, p_scratch );
+		} );
+	}
+}; // class stack
+
+
+// Gaussian approximation by 'Passes' box blurs, as 'box::cascaded'. Every box runs in place:
+// originals of the last 'r + 1' pixels are kept in ring buffer.
+template <typename LaneT, int Passes = 3>
+class box {
+	static_assert( Passes >= 3 && Passes <= 5 );
+
+	static constexpr double	sigma_coefficient = 2.5;
+
+	int		m_radii[Passes];	// Half widths of boxes, '0' - box is skipped
+
+	static __m128i load( const uint8_t * p ) { return _mm_loadu_si128( (const __m128i *)p ); }
+
+	// p_ring - 'r + 1' vectors
+	static void do_box( uint8_t * __restrict p_line, int len, int advance, int r, __m128i * __restrict p_ring ) {
+		// Division by '2r + 1' as 'sum * mul >> shr', '2^shr > 256 * d' (see 'stack::lut_mul').
+		// Result may be one more than exact one of 'box::cascaded' (its divisor needs 64-bit products).
+		const uint32_t d = r * 2 + 1;
+		uint8_t shr = 0;
+		while ( (uint64_t(1) << shr) <= uint64_t(256) * d ) shr++;
+		const uint32_t mul = uint32_t(((uint64_t(1) << shr) + d - 1) / d);
+
+		const int last = len - 1;
+		const __m128i first = load( p_line );
+		const __m128i end   = load( p_line + size_t(last) * advance );
+
+		LaneT sum = LaneT::splat( r );	// Rounding: '(sum + d / 2) / d'
+		sum += LaneT( first ) * (r + 1);
+		for ( int i = 1; i <= r; i++ ) sum += LaneT( i <= last ? load( p_line + size_t(i) * advance ) : end );
+
+		const uint8_t * p_in = p_line + size_t(std::min( r + 1, last )) * advance;
+		uint8_t * p = p_line;
+		int i_ring = 0;
+		for ( int i = 0; i < len; i++, p += advance ) {
+			p_ring[i_ring] = load( p );
+			_mm_storeu_si128( (__m128i *)p, (sum * mul >> shr).bytes() );
+			if ( ++i_ring > r ) i_ring = 0;
+
+			// Pixel 'i + r + 1' isn't written yet, pixel 'i - r' is in the next slot of ring.
+			if ( i + r + 1 <= last ) {
+				sum += LaneT( load( p_in ) );
+				p_in += advance;
+			} else {
+				sum += LaneT( end );
+			}
+			sum -= LaneT( i >= r ? p_ring[i_ring] : first );
+		}
+	}
+
+	void do_lines( uint8_t * p_line, int len, int advance, __m128i * p_ring ) const {
+		for ( int i = 0; i < Passes; i++ ) {
+			if ( m_radii[i] ) do_box( p_line, len, advance, m_radii[i], p_ring );
+		}
+	}
+
+public:
+	// 'sum * mul' must fit in 32 bits for the widest box
+	static constexpr int max_radius = 8192;
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( radius < 1 ) return;
+		san::blur::box::optimal_radii( std::min( radius, max_radius ) / sigma_coefficient, m_radii );
+
+		int r_max = *std::max_element( m_radii, m_radii + Passes );
+		if ( !r_max ) return;
+
+		for_each_lines( image, parallel_for, override_num_threads, r_max + 1, [this]( uint8_t * p, int len, int advance, __m128i * p_scratch ) {
+			do_lines( p, len, advance, p_scratch );
+		} );
+	}
+}; // class box
+
+} // namespace san::blur::a8
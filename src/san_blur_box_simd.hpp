@@ -0,0 +1,151 @@
+#pragma once
+
+namespace san::blur::box {
+
+// Half widths of 'Passes' boxes, which cascade is the closest to gaussian of 'sigma' (P. Kovesi, "Fast Almost-Gaussian Filtering"):
+// first 'm' boxes have width 'wl', the rest - 'wl + 2'. '0' - box is skipped.
+template <int Passes>
+void optimal_radii( double sigma, int (&radii)[Passes] ) {
+	double w_ideal = std::sqrt( 12. * sigma * sigma / Passes + 1. );
+	int wl = int(w_ideal);
+	if ( !(wl & 1) ) wl--;
+	int m = int(std::lround( (12. * sigma * sigma - Passes * wl * wl - 4. * Passes * wl - 3. * Passes) / (-4. * wl - 4.) ));
+	m = std::clamp( m, 0, Passes );
+
+	for ( int i = 0; i < Passes; i++ ) {
+		radii[i] = (i < m ? wl : wl + 2) / 2;
+	}
+}
+
+// Gaussian approximation by 'Passes' (3..5) successive box blurs. Cost per pixel doesn't depend on radius.
+// Box widths are the optimal ones for given sigma (see 'optimal_radii').
+// Sigma is 'radius / 2.5', as for 'gaussian::naive_test' and 'gaussian::simd'.
+//
+// Every box pass is a sliding running sum divided by 'divisor' (multiplication and shifts).
+// Passes are fused: a line (row, or strip of 'Columns' columns) is read from image once, all boxes run between
+// two buffers and result is written back once.
+template <typename CalcT, int Passes = 3, int Columns = 16>
+class cascaded {
+	static_assert( Passes >= 3 && Passes <= 5 );
+
+	static constexpr double	sigma_coefficient = 2.5;
+
+	int		m_radii[Passes];	// Half widths of boxes, '0' - box is skipped
+
+	// One box of radius 'r' over 'Lines' interleaved lines of 'len' pixels: pixel 'i' of line 'k' is 'p[i * Lines + k]'.
+	// Pixels out of line are the edge ones.
+	template <int Lines>
+	static void do_box( const uint32_t * __restrict p_src, uint32_t * __restrict p_dst, int len, int r ) {
+		const san::blur::stack::simd::divisor div( r * 2 + 1 );
+		const int last = len - 1;
+
+		CalcT sum[Lines];
+		for ( int k = 0; k < Lines; k++ ) {
+			sum[k] = CalcT( _mm_set1_epi32( r ) );	// Rounding: '(sum + d / 2) / d'
+			sum[k] += CalcT( p_src[k] ) * (r + 1);
+			for ( int i = 1; i <= std::min( r, last ); i++ ) sum[k] += CalcT( p_src[i * Lines + k] );
+			if ( r > last ) sum[k] += CalcT( p_src[last * Lines + k] ) * (r - last);	// Box is wider than line
+		}
+
+		for ( int i = 0; i < len; i++ ) {
+			const uint32_t * p_in  = p_src + std::min( i + r + 1, last ) * Lines;
+			const uint32_t * p_out = p_src + std::max( i - r, 0 ) * Lines;
+			uint32_t * p = p_dst + i * Lines;
+			for ( int k = 0; k < Lines; k++ ) {
+				p[k] = uint32_t(sum[k] / div);
+				sum[k] += CalcT( p_in[k] );
+				sum[k] -= CalcT( p_out[k] );
+			}
+		}
+	}
+
+	// Runs all boxes over lines in 'p_a', result is in 'p_a' too. 'p_b' - buffer of the same size.
+	template <int Lines>
+	void do_boxes( uint32_t * p_a, uint32_t * p_b, int len ) const {
+		uint32_t * p_src = p_a;
+		uint32_t * p_dst = p_b;
+		for ( int i = 0; i < Passes; i++ ) {
+			if ( !m_radii[i] ) continue;
+			do_box<Lines>( p_src, p_dst, len, m_radii[i] );
+			std::swap( p_src, p_dst );
+		}
+		if ( p_src != p_a ) std::memcpy( p_a, p_src, sizeof( uint32_t ) * len * Lines );
+	}
+
+	bool is_identity() const {
+		for ( int i = 0; i < Passes; i++ ) if ( m_radii[i] ) return false;
+		return true;
+	}
+
+	// Returns false if there is nothing to do
+	bool set_radius( int radius ) {
+		if ( radius < 1 ) return false;
+		optimal_radii( radius / sigma_coefficient, m_radii );
+		return !is_identity();
+	}
+
+public:
+	// Anisotropic blur, radius '0' skips the pass
+	template <typename ImageViewT, typename ParallelForT>
+	void blur_xy( ImageViewT & image, ParallelForT & parallel_for, int radius_x, int radius_y, int override_num_threads ) {
+		assert( image.components() == 4 );
+
+		int w = image.width();
+		int h = image.height();
+		int stride = image.stride() / image.components();
+
+		// Horizontal pass...
+		if ( set_radius( radius_x ) ) parallel_for.run_and_wait( 0, h, [&]( int a, int b ) {
+			std::unique_ptr <uint32_t[]> buf( new (std::nothrow) uint32_t [size_t(w) * 2] );
+			if ( !buf ) {
+				std::fprintf( stderr, "%s: couldn't allocate line buffers.\n", __FUNCTION__ );
+				return;
+			}
+
+			for ( int y = a; y < b; y++ ) {
+				uint32_t * p_row = (uint32_t *)image.row_ptr( y );
+				std::memcpy( buf.get(), p_row, sizeof( uint32_t ) * w );
+				do_boxes<1>( buf.get(), buf.get() + w, w );
+				std::memcpy( p_row, buf.get(), sizeof( uint32_t ) * w );
+			}
+		}, override_num_threads );
+
+		if ( !set_radius( radius_y ) ) return;
+
+		// Vertical pass (strips of columns)...
+		parallel_for.run_and_wait( 0, (w + Columns - 1) / Columns, [&]( int a, int b ) {
+			size_t size = size_t(h) * Columns;
+			std::unique_ptr <uint32_t[]> buf( new (std::nothrow) uint32_t [size * 2] );
+			if ( !buf ) {
+				std::fprintf( stderr, "%s: couldn't allocate strip buffers.\n", __FUNCTION__ );
+				return;
+			}
+
+			for ( int i = a; i < b; i++ ) {
+				int x = i * Columns;
+				int cols = std::min( Columns, w - x );
+				uint32_t * p_col = (uint32_t *)image.col_ptr( x );
+
+				// Missing columns of the last strip repeat the last column (they aren't written back).
+				for ( int y = 0; y < h; y++ ) {
+					uint32_t * p_dst = buf.get() + size_t(y) * Columns;
+					std::memcpy( p_dst, p_col + size_t(y) * stride, sizeof( uint32_t ) * cols );
+					std::fill( p_dst + cols, p_dst + Columns, p_dst[cols - 1] );
+				}
+
+				do_boxes<Columns>( buf.get(), buf.get() + size, h );
+
+				for ( int y = 0; y < h; y++ ) {
+					std::memcpy( p_col + size_t(y) * stride, buf.get() + size_t(y) * Columns, sizeof( uint32_t ) * cols );
+				}
+			}
+		}, override_num_threads );
+	}
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		blur_xy( image, parallel_for, radius, radius, override_num_threads );
+	}
+}; // class cascaded
+
+} // namespace san::blur::box
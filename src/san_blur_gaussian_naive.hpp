@@ -99,26 +99,60 @@ class naive {
 		}
 	}
 
+	// The same for pixels of other formats (see 'san_pixel.hpp'), result is rounded.
+	template <typename KernelT, typename PixelT>
+	void do_line( const KernelT & kernel, adaptor::basic_straight_line <PixelT> & line, int beg, int end ) {
+		using value_t = typename KernelT::value_type;
+
+		int		radius = kernel.radius();
+		int		length = end - beg;
+
+		PixelT *	p_stack = (PixelT *)SAN_STACK_ALLOC( sizeof( PixelT ) * length );
+		PixelT *	p_dst = p_stack;
+
+		for ( int coord = beg; coord < end; coord++ ) {
+			value_t sum[4] = {};
+			for ( int i = -radius; i <= radius; i++ ) {
+				value_t c[4];
+				pixel::unpack( line.get_pix( coord + i ), c );
+
+				value_t weight = kernel[i + radius];
+				for ( int k = 0; k < 4; k++ ) sum[k] += c[k] * weight;
+			}
+			*p_dst++ = pixel::pack<PixelT>( sum );
+		}
+
+		// Blit blurred line back...
+		line.set_pix_start( beg );
+		while ( length-- > 0 ) {
+			line.set_pix_next( *p_stack++ );
+		}
+	}
+
 public:
 	template <typename KernelT, typename ImageViewT, typename ParallelForT>
 	void operator () ( const KernelT & kernel, ImageViewT & image, ParallelForT & parallel_for, int override_num_threads ) {
 		assert( image.components() == 4 );
 
-		// Horizontal pass...
-		parallel_for.run_and_wait( 0, image.height(), [&]( int beg, int end ) {
-			for ( int i = beg; i < end; i++ ) {
-				adaptor::straight_line line( (uint32_t *)image.row_ptr( i ), image.width(), 1 );
-				do_line( kernel, line, 0, image.width() );
-			}
-		}, override_num_threads );
-
-		// Vertical pass...
-		parallel_for.run_and_wait( 0, image.width(), [&]( int beg, int end ) {
-			for ( int i = beg; i < end; i++ ) {
-				adaptor::straight_line line( (uint32_t *)image.col_ptr( i ), image.height(), image.stride() / image.components() );
-				do_line( kernel, line, 0, image.height() );
-			}
-		}, override_num_threads );
+		pixel::visit( image.format(), [&]( auto tag ) {
+			using PixelT = decltype(tag);
+
+			// Horizontal pass...
+			parallel_for.run_and_wait( 0, image.height(), [&]( int beg, int end ) {
+				for ( int i = beg; i < end; i++ ) {
+					adaptor::basic_straight_line <PixelT> line( (PixelT *)image.row_ptr( i ), image.width(), 1 );
+					do_line( kernel, line, 0, image.width() );
+				}
+			}, override_num_threads );
+
+			// Vertical pass...
+			parallel_for.run_and_wait( 0, image.width(), [&]( int beg, int end ) {
+				for ( int i = beg; i < end; i++ ) {
+					adaptor::basic_straight_line <PixelT> line( (PixelT *)image.col_ptr( i ), image.height(), image.stride() / int(sizeof( PixelT )) );
+					do_line( kernel, line, 0, image.height() );
+				}
+			}, override_num_threads );
+		} );
 	}
 }; // class naive
 
@@ -0,0 +1,260 @@
+#pragma once
+
+// Separable gaussian with fixed-point kernels and '_mm_madd_epi16'.
+
+namespace san::blur::gaussian {
+
+// Normalized kernels in 'shift' bits fixed point, calculated once per radius on first use.
+// Only half of kernel is stored (it's symmetric): weights of taps 0 (center), 1, ..., radius, by pairs -
+// low 16 bits is weight of even tap, high 16 bits - of the next odd one. Odd tap after the last one has zero weight.
+class kernel_cache {
+public:
+	static constexpr int	max_radius	= 254;
+	static constexpr int	shift		= 14;
+
+private:
+	std::array <std::vector <uint32_t>, max_radius + 1>	m_kernels;
+	double												m_sigma_coefficient;
+
+	void calculate( int radius, std::vector <uint32_t> & kernel ) {
+		double sigma = radius / m_sigma_coefficient;
+
+		std::vector <double> w( radius + 2, 0. );
+		double sum = 0;
+		for ( int i = 0; i <= radius; i++ ) {
+			w[i] = std::exp( -(i * i) / (sigma * sigma * 2) );
+			sum += i ? w[i] * 2 : w[i];
+		}
+
+		// Rounding error goes to center tap, so sum of weights is exactly '1 << shift'.
+		std::vector <int> q( radius + 2, 0 );
+		int q_sum = 0;
+		for ( int i = radius; i >= 0; i-- ) {
+			q[i] = int(std::lround( w[i] / sum * (1 << shift) ));
+			q_sum += i ? q[i] * 2 : q[i];
+		}
+		q[0] += (1 << shift) - q_sum;
+
+		kernel.resize( (radius + 2) / 2 );
+		for ( size_t k = 0; k < kernel.size(); k++ ) {
+			kernel[k] = uint32_t(uint16_t(q[k * 2])) | uint32_t(uint16_t(q[k * 2 + 1])) << 16;
+		}
+	}
+
+public:
+	kernel_cache( double sigma_coefficient = 2.5 ) : m_sigma_coefficient( sigma_coefficient ) {}
+
+	const std::vector <uint32_t> & get( int radius ) {
+		std::vector <uint32_t> & kernel = m_kernels[radius];
+		if ( kernel.empty() ) calculate( radius, kernel );
+		return kernel;
+	}
+}; // class kernel_cache
+
+
+// Blurs 'pixels' adjacent pixels at once.
+//  p_src - first of source pixels (taps are at 'p_src +- i * advance')
+//   p_w  - kernel from 'kernel_cache', 'n_pairs' pairs of weights
+// Source pixels (4 x 8 bits) are widened to 16 bits, symmetric taps are added first ('p[-i] + p[i]' fits in 16 bits),
+// then two taps are interleaved and multiplied with two weights by one 'madd'.
+
+// Four pixels in '__m128i'. Requires SSE4.1.
+struct sse128_madd_t {
+	static constexpr int pixels = 4;
+
+	static void tap( const uint32_t * p, int offset, __m128i & lo, __m128i & hi ) {
+		const __m128i zero = _mm_setzero_si128();
+		__m128i a = _mm_loadu_si128( (const __m128i *)(p - offset) );
+		__m128i b = _mm_loadu_si128( (const __m128i *)(p + offset) );
+		lo = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) );
+		hi = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) );
+	}
+
+	static void convolve( const uint32_t * p_src, int advance, const uint32_t * p_w, int n_pairs, uint32_t * p_dst ) {
+		const __m128i zero = _mm_setzero_si128();
+
+		// Accumulators (one per pixel) start from rounding constant.
+		__m128i acc0 = _mm_set1_epi32( 1 << (kernel_cache::shift - 1) );
+		__m128i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+		auto madd = [&]( const __m128i & lo0, const __m128i & hi0, const __m128i & lo1, const __m128i & hi1, const __m128i & w ) {
+			acc0 = _mm_add_epi32( acc0, _mm_madd_epi16( _mm_unpacklo_epi16( lo0, lo1 ), w ) );
+			acc1 = _mm_add_epi32( acc1, _mm_madd_epi16( _mm_unpackhi_epi16( lo0, lo1 ), w ) );
+			acc2 = _mm_add_epi32( acc2, _mm_madd_epi16( _mm_unpacklo_epi16( hi0, hi1 ), w ) );
+			acc3 = _mm_add_epi32( acc3, _mm_madd_epi16( _mm_unpackhi_epi16( hi0, hi1 ), w ) );
+		};
+
+		__m128i lo0, hi0, lo1, hi1;
+
+		// Center tap is single, so it's taken alone.
+		__m128i c = _mm_loadu_si128( (const __m128i *)p_src );
+		lo0 = _mm_unpacklo_epi8( c, zero );
+		hi0 = _mm_unpackhi_epi8( c, zero );
+		tap( p_src, advance, lo1, hi1 );
+		madd( lo0, hi0, lo1, hi1, _mm_set1_epi32( p_w[0] ) );
+
+		for ( int k = 1; k < n_pairs; k++ ) {
+			tap( p_src, advance * (k * 2    ), lo0, hi0 );
+			tap( p_src, advance * (k * 2 + 1), lo1, hi1 );
+			madd( lo0, hi0, lo1, hi1, _mm_set1_epi32( p_w[k] ) );
+		}
+
+		acc0 = _mm_srai_epi32( acc0, kernel_cache::shift );
+		acc1 = _mm_srai_epi32( acc1, kernel_cache::shift );
+		acc2 = _mm_srai_epi32( acc2, kernel_cache::shift );
+		acc3 = _mm_srai_epi32( acc3, kernel_cache::shift );
+		__m128i v = _mm_packus_epi16( _mm_packs_epi32( acc0, acc1 ), _mm_packs_epi32( acc2, acc3 ) );
+		_mm_storeu_si128( (__m128i *)p_dst, v );
+	}
+}; // struct sse128_madd_t
+
+
+#if defined( __AVX2__ )
+
+// Eight pixels in '__m256i'.
+struct avx256_madd_t {
+	static constexpr int pixels = 8;
+
+	static void tap( const uint32_t * p, int offset, __m256i & lo, __m256i & hi ) {
+		__m256i a = _mm256_loadu_si256( (const __m256i *)(p - offset) );
+		__m256i b = _mm256_loadu_si256( (const __m256i *)(p + offset) );
+		lo = _mm256_add_epi16( _mm256_cvtepu8_epi16( _mm256_castsi256_si128( a ) ),      _mm256_cvtepu8_epi16( _mm256_castsi256_si128( b ) ) );
+		hi = _mm256_add_epi16( _mm256_cvtepu8_epi16( _mm256_extracti128_si256( a, 1 ) ), _mm256_cvtepu8_epi16( _mm256_extracti128_si256( b, 1 ) ) );
+	}
+
+	static void convolve( const uint32_t * p_src, int advance, const uint32_t * p_w, int n_pairs, uint32_t * p_dst ) {
+
+		// 'lo' has pixels 0, 1 | 2, 3 (by 128-bit halves), so in-lane unpacks give pixels 0 | 2 and 1 | 3.
+		__m256i acc0 = _mm256_set1_epi32( 1 << (kernel_cache::shift - 1) );
+		__m256i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+		auto madd = [&]( const __m256i & lo0, const __m256i & hi0, const __m256i & lo1, const __m256i & hi1, const __m256i & w ) {
+			acc0 = _mm256_add_epi32( acc0, _mm256_madd_epi16( _mm256_unpacklo_epi16( lo0, lo1 ), w ) );	// 0 | 2
+			acc1 = _mm256_add_epi32( acc1, _mm256_madd_epi16( _mm256_unpackhi_epi16( lo0, lo1 ), w ) );	// 1 | 3
+			acc2 = _mm256_add_epi32( acc2, _mm256_madd_epi16( _mm256_unpacklo_epi16( hi0, hi1 ), w ) );	// 4 | 6
+			acc3 = _mm256_add_epi32( acc3, _mm256_madd_epi16( _mm256_unpackhi_epi16( hi0, hi1 ), w ) );	// 5 | 7
+		};
+
+		__m256i lo0, hi0, lo1, hi1;
+
+		__m256i c = _mm256_loadu_si256( (const __m256i *)p_src );
+		lo0 = _mm256_cvtepu8_epi16( _mm256_castsi256_si128( c ) );
+		hi0 = _mm256_cvtepu8_epi16( _mm256_extracti128_si256( c, 1 ) );
+		tap( p_src, advance, lo1, hi1 );
+		madd( lo0, hi0, lo1, hi1, _mm256_set1_epi32( p_w[0] ) );
+
+		for ( int k = 1; k < n_pairs; k++ ) {
+			tap( p_src, advance * (k * 2    ), lo0, hi0 );
+			tap( p_src, advance * (k * 2 + 1), lo1, hi1 );
+			madd( lo0, hi0, lo1, hi1, _mm256_set1_epi32( p_w[k] ) );
+		}
+
+		acc0 = _mm256_srai_epi32( acc0, kernel_cache::shift );
+		acc1 = _mm256_srai_epi32( acc1, kernel_cache::shift );
+		acc2 = _mm256_srai_epi32( acc2, kernel_cache::shift );
+		acc3 = _mm256_srai_epi32( acc3, kernel_cache::shift );
+
+		// Bytes are 0 1 4 5 | 2 3 6 7 by 64 bits, restore order.
+		__m256i v = _mm256_packus_epi16( _mm256_packs_epi32( acc0, acc1 ), _mm256_packs_epi32( acc2, acc3 ) );
+		_mm256_storeu_si256( (__m256i *)p_dst, _mm256_permute4x64_epi64( v, _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+	}
+}; // struct avx256_madd_t
+
+#endif // defined( __AVX2__ )
+
+
+// Both passes read from a line (or strip of 'Columns' columns) copied to buffer with replicated border pixels,
+// so borders are handled once by the copy and the convolution loop has no clamping at all.
+template <typename LaneT, int Columns = 16>
+class simd {
+	static_assert( Columns % LaneT::pixels == 0 );
+
+	kernel_cache *	m_p_kernels;
+
+	// Writes 'n' (<= 'LaneT::pixels') pixels.
+	static void convolve_n( const uint32_t * p_src, int advance, const uint32_t * p_w, int n_pairs, uint32_t * p_dst, int n ) {
+		if ( SAN_LIKELY( n == LaneT::pixels ) ) {
+			LaneT::convolve( p_src, advance, p_w, n_pairs, p_dst );
+		} else {
+			uint32_t tmp[LaneT::pixels];
+			LaneT::convolve( p_src, advance, p_w, n_pairs, tmp );
+			std::memcpy( p_dst, tmp, sizeof( uint32_t ) * n );
+		}
+	}
+
+public:
+	// Kernels are shared (e.g. by SSE and AVX2 instances), 'kernels' must outlive this object.
+	explicit simd( kernel_cache & kernels ) : m_p_kernels( &kernels ) {}
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		assert( image.components() == 4 );
+
+		if ( radius < 1 ) return;
+		if ( radius > kernel_cache::max_radius ) radius = kernel_cache::max_radius;
+
+		const std::vector <uint32_t> & kernel = m_p_kernels->get( radius );
+		const uint32_t * p_w = kernel.data();
+		int n_pairs = int(kernel.size());
+
+		int w = image.width();
+		int h = image.height();
+		int stride = image.stride() / image.components();
+		int pad = n_pairs * 2;	// Farthest tap (including zero weighted one) is 'n_pairs * 2 - 1'
+
+		// Horizontal pass...
+		parallel_for.run_and_wait( 0, h, [&]( int a, int b ) {
+			std::unique_ptr <uint32_t[]> buf( new (std::nothrow) uint32_t [w + pad * 2 + LaneT::pixels] );
+			if ( !buf ) {
+				std::fprintf( stderr, "%s: couldn't allocate line buffer.\n", __FUNCTION__ );
+				return;
+			}
+
+			for ( int y = a; y < b; y++ ) {
+				uint32_t * p_row = (uint32_t *)image.row_ptr( y );
+				uint32_t * p_buf = buf.get() + pad;
+
+				std::fill( buf.get(), p_buf, p_row[0] );
+				std::memcpy( p_buf, p_row, sizeof( uint32_t ) * w );
+				std::fill( p_buf + w, p_buf + w + pad + LaneT::pixels, p_row[w - 1] );
+
+				for ( int x = 0; x < w; x += LaneT::pixels ) {
+					convolve_n( p_buf + x, 1, p_w, n_pairs, p_row + x, std::min( LaneT::pixels, w - x ) );
+				}
+			}
+		}, override_num_threads );
+
+		// Vertical pass (strips of columns)...
+		parallel_for.run_and_wait( 0, (w + Columns - 1) / Columns, [&]( int a, int b ) {
+			std::unique_ptr <uint32_t[]> buf( new (std::nothrow) uint32_t [size_t(h + pad * 2) * Columns] );
+			if ( !buf ) {
+				std::fprintf( stderr, "%s: couldn't allocate strip buffer.\n", __FUNCTION__ );
+				return;
+			}
+
+			for ( int i = a; i < b; i++ ) {
+				int x = i * Columns;
+				int cols = std::min( Columns, w - x );
+				uint32_t * p_col = (uint32_t *)image.col_ptr( x );
+
+				// Copy strip, missing columns of the last strip repeat the last column (they aren't written back).
+				for ( int y = -pad; y < h + pad; y++ ) {
+					const uint32_t * p_src = p_col + std::clamp( y, 0, h - 1 ) * stride;
+					uint32_t * p_dst = buf.get() + (y + pad) * Columns;
+					std::memcpy( p_dst, p_src, sizeof( uint32_t ) * cols );
+					std::fill( p_dst + cols, p_dst + Columns, p_src[cols - 1] );
+				}
+
+				for ( int y = 0; y < h; y++ ) {
+					const uint32_t * p_src = buf.get() + (y + pad) * Columns;
+					uint32_t * p_dst = p_col + y * stride;
+					for ( int c = 0; c < cols; c += LaneT::pixels ) {
+						convolve_n( p_src + c, Columns, p_w, n_pairs, p_dst + c, std::min( LaneT::pixels, cols - c ) );
+					}
+				}
+			}
+		}, override_num_threads );
+	}
+}; // class simd
+
+} // namespace san::blur::gaussian
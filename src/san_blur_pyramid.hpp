@@ -0,0 +1,197 @@
+#pragma once
+
+namespace san::blur::pyramid {
+
+// Pyramid (mip chain) mode for big radii: output of big blur is low-frequency, so most of full resolution work is redundant.
+// Image is decimated 'levels' times by 2x2 box filter, blurred there with smaller radius by 'BlurT'
+// and upsampled bilinearly back. Requires SSE4.1.
+
+// Halves 'src' into 'dst' ('(width + 1) / 2' x '(height + 1) / 2'). Every pixel is rounded average of 2x2 block,
+// odd last column or row is averaged with itself.
+template <typename ImageViewT, typename ParallelForT>
+void downsample_2x( const ImageViewT & src, san::surface & dst, ParallelForT & parallel_for, int override_num_threads ) {
+	assert( src.components() == 4 && dst.components() == 4 );
+	assert( dst.width() == (src.width() + 1) / 2 && dst.height() == (src.height() + 1) / 2 );
+
+	const int sw = src.width();
+	const int sh = src.height();
+	const int dw = dst.width();
+
+	parallel_for.run_and_wait( 0, dst.height(), [&]( int a, int b ) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i two  = _mm_set1_epi16( 2 );
+
+		for ( int y = a; y < b; y++ ) {
+			const uint32_t * p0 = (const uint32_t *)src.row_ptr( y * 2 );
+			const uint32_t * p1 = (const uint32_t *)src.row_ptr( std::min( y * 2 + 1, sh - 1 ) );
+			uint32_t * p_dst = (uint32_t *)dst.row_ptr( y );
+
+			// Two pixels from four columns of both rows...
+			int x = 0;
+			for ( ; x * 2 + 4 <= sw; x += 2 ) {
+				__m128i r0 = _mm_loadu_si128( (const __m128i *)(p0 + x * 2) );
+				__m128i r1 = _mm_loadu_si128( (const __m128i *)(p1 + x * 2) );
+				__m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( r0, zero ), _mm_unpacklo_epi8( r1, zero ) );	// Columns 0 | 1
+				__m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( r0, zero ), _mm_unpackhi_epi8( r1, zero ) );	// Columns 2 | 3
+				__m128i s  = _mm_add_epi16( _mm_unpacklo_epi64( lo, hi ), _mm_unpackhi_epi64( lo, hi ) );	// 0 + 1 | 2 + 3
+				s = _mm_srli_epi16( _mm_add_epi16( s, two ), 2 );
+				_mm_storel_epi64( (__m128i *)(p_dst + x), _mm_packus_epi16( s, s ) );
+			}
+
+			for ( ; x < dw; x++ ) {
+				int x1 = std::min( x * 2 + 1, sw - 1 );
+				__m128i s = _mm_add_epi16(
+					_mm_add_epi16( _mm_cvtepu8_epi16( _mm_cvtsi32_si128( p0[x * 2] ) ), _mm_cvtepu8_epi16( _mm_cvtsi32_si128( p0[x1] ) ) ),
+					_mm_add_epi16( _mm_cvtepu8_epi16( _mm_cvtsi32_si128( p1[x * 2] ) ), _mm_cvtepu8_epi16( _mm_cvtsi32_si128( p1[x1] ) ) ) );
+				s = _mm_srli_epi16( _mm_add_epi16( s, two ), 2 );
+				p_dst[x] = _mm_cvtsi128_si32( _mm_packus_epi16( s, s ) );
+			}
+		}
+	}, override_num_threads );
+}
+
+
+// Bilinear upsampling of 'src' to the whole 'dst' (pixel centers are aligned), 7-bit weights.
+// Rows are interpolated vertically into 16-bit buffer, then horizontally with '_mm_madd_epi16'.
+template <typename ImageViewT, typename ParallelForT>
+void upsample( const san::surface & src, ImageViewT & dst, ParallelForT & parallel_for, int override_num_threads ) {
+	assert( src.components() == 4 && dst.components() == 4 );
+
+	constexpr int one = 128;
+
+	const int sw = src.width();
+	const int sh = src.height();
+	const int dw = dst.width();
+	const float scale_x = float(sw) / dw;
+	const float scale_y = float(sh) / dst.height();
+
+	// Source position of 'i' and weight of the next pixel
+	auto position = []( int i, float scale, int size, int & i0, int & i1, int & f ) {
+		float s = std::clamp( (i + .5f) * scale - .5f, 0.f, float(size - 1) );
+		i0 = int(s);
+		i1 = std::min( i0 + 1, size - 1 );
+		f  = int((s - i0) * one + .5f);
+	};
+
+	// Columns: first source pixel and packed weights 'w0 | w1 << 16'.
+	std::unique_ptr <int[]> x_src( new (std::nothrow) int [dw * 2] );
+	if ( !x_src ) {
+		std::fprintf( stderr, "%s: couldn't allocate column table.\n", __FUNCTION__ );
+		return;
+	}
+	for ( int x = 0; x < dw; x++ ) {
+		int x0, x1, f;
+		position( x, scale_x, sw, x0, x1, f );
+		x_src[x * 2]     = x0;
+		x_src[x * 2 + 1] = (one - f) | f << 16;
+	}
+
+	parallel_for.run_and_wait( 0, dst.height(), [&]( int a, int b ) {
+		// One more pixel, so the last column reads its neighbour from buffer.
+		std::unique_ptr <int16_t[]> buf( new (std::nothrow) int16_t [(sw + 1) * 4] );
+		if ( !buf ) {
+			std::fprintf( stderr, "%s: couldn't allocate row buffer.\n", __FUNCTION__ );
+			return;
+		}
+		int16_t * p_buf = buf.get();
+
+		for ( int y = a; y < b; y++ ) {
+			int y0, y1, f;
+			position( y, scale_y, sh, y0, y1, f );
+
+			// Vertical...
+			const uint32_t * p0 = (const uint32_t *)src.row_ptr( y0 );
+			const uint32_t * p1 = (const uint32_t *)src.row_ptr( y1 );
+			const __m128i w0 = _mm_set1_epi16( int16_t(one - f) );
+			const __m128i w1 = _mm_set1_epi16( int16_t(f) );
+			int x = 0;
+			for ( ; x + 2 <= sw; x += 2 ) {
+				__m128i v0 = _mm_cvtepu8_epi16( _mm_loadl_epi64( (const __m128i *)(p0 + x) ) );
+				__m128i v1 = _mm_cvtepu8_epi16( _mm_loadl_epi64( (const __m128i *)(p1 + x) ) );
+				_mm_storeu_si128( (__m128i *)(p_buf + x * 4), _mm_add_epi16( _mm_mullo_epi16( v0, w0 ), _mm_mullo_epi16( v1, w1 ) ) );
+			}
+			for ( ; x < sw; x++ ) {
+				__m128i v0 = _mm_cvtepu8_epi16( _mm_cvtsi32_si128( p0[x] ) );
+				__m128i v1 = _mm_cvtepu8_epi16( _mm_cvtsi32_si128( p1[x] ) );
+				_mm_storel_epi64( (__m128i *)(p_buf + x * 4), _mm_add_epi16( _mm_mullo_epi16( v0, w0 ), _mm_mullo_epi16( v1, w1 ) ) );
+			}
+			std::memcpy( p_buf + sw * 4, p_buf + (sw - 1) * 4, sizeof( int16_t ) * 4 );
+
+			// Horizontal...
+			const __m128i round = _mm_set1_epi32( one * one / 2 );
+			uint32_t * p_dst = (uint32_t *)dst.row_ptr( y );
+			for ( x = 0; x < dw; x++ ) {
+				const int16_t * p = p_buf + x_src[x * 2] * 4;
+				__m128i t = _mm_unpacklo_epi16( _mm_loadl_epi64( (const __m128i *)p ), _mm_loadl_epi64( (const __m128i *)(p + 4) ) );
+				__m128i v = _mm_madd_epi16( t, _mm_set1_epi32( x_src[x * 2 + 1] ) );
+				v = _mm_srli_epi32( _mm_add_epi32( v, round ), 14 );
+				v = _mm_packus_epi32( v, v );
+				p_dst[x] = _mm_cvtsi128_si32( _mm_packus_epi16( v, v ) );
+			}
+		}
+	}, override_num_threads );
+}
+
+
+// 'BlurT' - stack blur implementation (radius is in stack blur units), used at the reduced level.
+// Number of levels is chosen from radius: as many as keep reduced radius at least 'MinRadius',
+// so radii below 'MinRadius * 2' (64 by default) are blurred by 'BlurT' at full resolution.
+// Radius at the reduced level is corrected for variance added by decimation and upsampling.
+// Radius may be bigger than 254, only reduced one is limited.
+template <typename BlurT, int MinRadius = 32, int MaxLevels = 6>
+class mip_chain {
+	static_assert( MinRadius > 0 && MaxLevels > 0 );
+
+	BlurT	m_blur;
+
+	// Levels stop at 'MinRadius * 4' pixels, so small images aren't reduced to nothing.
+	static int levels_for( int radius, int min_size ) {
+		int levels = 0;
+		while ( levels < MaxLevels && (radius >> (levels + 1)) >= MinRadius && (min_size >> (levels + 1)) >= MinRadius * 4 ) levels++;
+		return levels;
+	}
+
+	// Stack blur of radius 'r' is triangle of variance 'r * (r + 2) / 6'.
+	// Decimations add '(4^levels - 1) / 12', bilinear upsampling '(4^levels - 1) / 6' (at full resolution).
+	static int reduced_radius( int radius, int levels ) {
+		double scale = double(1 << levels) * (1 << levels);
+		double var = (radius * (radius + 2.) / 6. - (scale - 1.) / 4.) / scale;
+		int r = int(std::lround( std::sqrt( 6. * std::max( var, 0. ) + 1. ) - 1. ));
+		return std::clamp( r, 1, 254 );
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		assert( image.components() == 4 );
+
+		int levels = levels_for( radius, std::min( image.width(), image.height() ) );
+		if ( !levels ) {
+			m_blur( image, parallel_for, radius, override_num_threads );
+			return;
+		}
+
+		std::unique_ptr <san::surface> chain[MaxLevels];
+		for ( int i = 0, w = image.width(), h = image.height(); i < levels; i++ ) {
+			w = (w + 1) / 2;
+			h = (h + 1) / 2;
+			chain[i].reset( new (std::nothrow) san::surface( w, h, 4 ) );
+			if ( !chain[i] || !*chain[i] ) {
+				std::fprintf( stderr, "%s: couldn't allocate level %d.\n", __FUNCTION__, i + 1 );
+				return;
+			}
+		}
+
+		downsample_2x( image, *chain[0], parallel_for, override_num_threads );
+		for ( int i = 1; i < levels; i++ ) {
+			downsample_2x( *chain[i - 1], *chain[i], parallel_for, override_num_threads );
+		}
+
+		san::surface_view level( *chain[levels - 1] );
+		m_blur( level, parallel_for, reduced_radius( radius, levels ), override_num_threads );
+
+		upsample( *chain[levels - 1], image, parallel_for, override_num_threads );
+	}
+}; // class mip_chain
+
+} // namespace san::blur::pyramid
@@ -33,33 +33,35 @@ struct naive_calc {
 	}
 }; // struct naive_calc
 
+// Coefficients of recursive filter: y[n] = c * x[n] + c1 * y[n - 1] + c2 * y[n - 2] + c3 * y[n - 3]
+template <typename ValueT>
+void calc_coefficients( ValueT radius, ValueT & c, ValueT & c1, ValueT & c2, ValueT & c3 ) {
+	ValueT s = radius * 0.5f;
+
+	ValueT q1  = s < 2.5f
+		? 3.97156f - 4.14554f * std::sqrt( 1 - 0.26891f * s )
+		: 0.98711f * s - 0.96330f;
+
+	ValueT q2 = q1 * q1;
+	ValueT q3 = q2 * q1;
+
+	ValueT c0;
+	c0 = 1.57825f + 2.44413f * q1 +  1.42810f * q2 +  0.422205f * q3;
+	c1 =            2.44413f * q1 +  2.85619f * q2 +  1.266610f * q3;
+	c2 =                            -1.42810f * q2 + -1.266610f * q3;
+	c3 =                                              0.422205f * q3;
+
+	c0 = 1 / c0;
+	c   = 1 - (c1 + c2 + c3) * c0;
+	c1 *= c0;
+	c2 *= c0;
+	c3 *= c0;
+}
+
 template <typename CalcT = naive_calc<>>
 class naive {
 	using	value_type	= typename CalcT::value_type;
 
-	void calc_coefficients( value_type radius, value_type & c, value_type & c1, value_type & c2, value_type & c3 ) {
-		value_type s = radius * 0.5f;
-
-		value_type q1  = s < 2.5f
-			? 3.97156f - 4.14554f * std::sqrt( 1 - 0.26891f * s )
-			: 0.98711f * s - 0.96330f;
-
-		value_type q2 = q1 * q1;
-		value_type q3 = q2 * q1;
-
-		value_type c0;
-		c0 = 1.57825f + 2.44413f * q1 +  1.42810f * q2 +  0.422205f * q3;
-		c1 =            2.44413f * q1 +  2.85619f * q2 +  1.266610f * q3;
-		c2 =                            -1.42810f * q2 + -1.266610f * q3;
-		c3 =                                              0.422205f * q3;
-
-		c0 = 1 / c0;
-		c   = 1 - (c1 + c2 + c3) * c0;
-		c1 *= c0;
-		c2 *= c0;
-		c3 *= c0;
-	}
-
 public:
 	template <typename ImageViewT, typename ParallelForT>
 	void operator () ( ImageViewT & image, ParallelForT & parallel_for, value_type radius, int override_num_threads ) {
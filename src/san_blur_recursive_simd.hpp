@@ -0,0 +1,277 @@
+#pragma once
+
+namespace san::blur::recursive {
+
+// Lanes for 'simd' recursive blur. Pixel is four floats (one per component).
+// Loaded from and stored to pixels of any 'pixel_format' (see 'san_pixel.hpp'), 32bpp ones have faster special versions.
+// FMA is used only if it is enabled for compiler (e.g. '-mfma' or '-march=...'), otherwise multiply and add.
+
+// One pixel in '__m128'. Requires SSE4.1.
+class sse128_f32_t {
+	__m128 m_vec;
+
+public:
+	static constexpr int pixels = 1;
+
+	sse128_f32_t() = default;
+	sse128_f32_t( const __m128 & v ) : m_vec( v ) {}
+	sse128_f32_t( float v ) : m_vec( _mm_set1_ps( v ) ) {}
+
+	operator __m128 () const { return m_vec; }
+
+	// 'second' - offset of the second pixel, not used here
+	template <typename PixelT>
+	static sse128_f32_t load( const PixelT * p, int /*second*/ ) {
+		return pixel::load_ps( p );
+	}
+
+	template <typename PixelT>
+	void store( PixelT * p, int /*second*/ ) const {
+		pixel::store_ps( p, m_vec );
+	}
+
+	// a * b + c
+	static sse128_f32_t madd( const sse128_f32_t & a, const sse128_f32_t & b, const sse128_f32_t & c ) {
+#if defined( __FMA__ )
+		return _mm_fmadd_ps( a, b, c );
+#else
+		return _mm_add_ps( _mm_mul_ps( a, b ), c );
+#endif
+	}
+
+	sse128_f32_t operator + ( const sse128_f32_t & rhs ) const { return _mm_add_ps( m_vec, rhs ); }
+	sse128_f32_t operator - ( const sse128_f32_t & rhs ) const { return _mm_sub_ps( m_vec, rhs ); }
+	sse128_f32_t operator * ( const sse128_f32_t & rhs ) const { return _mm_mul_ps( m_vec, rhs ); }
+}; // class sse128_f32_t
+
+
+#if defined( __AVX2__ )
+
+// Two pixels in '__m256', one per 128-bit half.
+class avx256_f32_t {
+	__m256 m_vec;
+
+public:
+	static constexpr int pixels = 2;
+
+	avx256_f32_t() = default;
+	avx256_f32_t( const __m256 & v ) : m_vec( v ) {}
+	avx256_f32_t( float v ) : m_vec( _mm256_set1_ps( v ) ) {}
+
+	operator __m256 () const { return m_vec; }
+
+	// Pixels 'p[0]' and 'p[second]'
+	static avx256_f32_t load( const uint32_t * p, int second ) {
+		__m128i v = _mm_unpacklo_epi32( _mm_cvtsi32_si128( p[0] ), _mm_cvtsi32_si128( p[second] ) );
+		return _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( v ) );
+	}
+
+	void store( uint32_t * p, int second ) const {
+		__m256i v = _mm256_cvtps_epi32( m_vec );
+		v = _mm256_packus_epi32( v, v );	// In-lane packs, pixel in low dword of each half
+		v = _mm256_packus_epi16( v, v );
+		p[second] = _mm256_extract_epi32( v, 4 );
+		p[0]      = _mm256_cvtsi256_si32( v );
+	}
+
+	template <typename PixelT>
+	static avx256_f32_t load( const PixelT * p, int second ) {
+		return _mm256_set_m128( pixel::load_ps( p + second ), pixel::load_ps( p ) );
+	}
+
+	template <typename PixelT>
+	void store( PixelT * p, int second ) const {
+		pixel::store_ps( p + second, _mm256_extractf128_ps( m_vec, 1 ) );
+		pixel::store_ps( p, _mm256_castps256_ps128( m_vec ) );
+	}
+
+	static avx256_f32_t madd( const avx256_f32_t & a, const avx256_f32_t & b, const avx256_f32_t & c ) {
+#if defined( __FMA__ )
+		return _mm256_fmadd_ps( a, b, c );
+#else
+		return _mm256_add_ps( _mm256_mul_ps( a, b ), c );
+#endif
+	}
+
+	avx256_f32_t operator + ( const avx256_f32_t & rhs ) const { return _mm256_add_ps( m_vec, rhs ); }
+	avx256_f32_t operator - ( const avx256_f32_t & rhs ) const { return _mm256_sub_ps( m_vec, rhs ); }
+	avx256_f32_t operator * ( const avx256_f32_t & rhs ) const { return _mm256_mul_ps( m_vec, rhs ); }
+}; // class avx256_f32_t
+
+
+// One pixel in '__m256d'. Twice slower than floats, but precise for any radius.
+class avx256_f64_t {
+	__m256d m_vec;
+
+public:
+	static constexpr int pixels = 1;
+
+	avx256_f64_t() = default;
+	avx256_f64_t( const __m256d & v ) : m_vec( v ) {}
+	avx256_f64_t( double v ) : m_vec( _mm256_set1_pd( v ) ) {}
+
+	operator __m256d () const { return m_vec; }
+
+	static avx256_f64_t load( const uint32_t * p, int /*second*/ ) {
+		return _mm256_cvtepi32_pd( _mm_cvtepu8_epi32( _mm_cvtsi32_si128( *p ) ) );
+	}
+
+	void store( uint32_t * p, int /*second*/ ) const {
+		__m128i v = _mm256_cvtpd_epi32( m_vec );
+		v = _mm_packus_epi32( v, v );
+		v = _mm_packus_epi16( v, v );
+		*p = _mm_cvtsi128_si32( v );
+	}
+
+	template <typename PixelT>
+	static avx256_f64_t load( const PixelT * p, int /*second*/ ) {
+		return _mm256_cvtps_pd( pixel::load_ps( p ) );
+	}
+
+	template <typename PixelT>
+	void store( PixelT * p, int /*second*/ ) const {
+		pixel::store_ps( p, _mm256_cvtpd_ps( m_vec ) );
+	}
+
+	static avx256_f64_t madd( const avx256_f64_t & a, const avx256_f64_t & b, const avx256_f64_t & c ) {
+#if defined( __FMA__ )
+		return _mm256_fmadd_pd( a, b, c );
+#else
+		return _mm256_add_pd( _mm256_mul_pd( a, b ), c );
+#endif
+	}
+
+	avx256_f64_t operator + ( const avx256_f64_t & rhs ) const { return _mm256_add_pd( m_vec, rhs ); }
+	avx256_f64_t operator - ( const avx256_f64_t & rhs ) const { return _mm256_sub_pd( m_vec, rhs ); }
+	avx256_f64_t operator * ( const avx256_f64_t & rhs ) const { return _mm256_mul_pd( m_vec, rhs ); }
+}; // class avx256_f64_t
+
+#endif // defined( __AVX2__ )
+
+
+// Recursive (IIR) gaussian approximation, same filter as 'naive', but vectorized and parallel. Cost doesn't depend on radius.
+// 'Interleave' lines (of 'VecT::pixels' pixels each) are filtered at once, so their independent recursions hide latency:
+// several rows in horizontal pass and several adjacent columns in vertical one.
+// Float lanes are within +-1 of exact result up to radius ~128, rounding errors grow after that - use 'avx256_f64_t' there.
+template <typename VecT, int Interleave = 4>
+class simd {
+	static constexpr int	lines = Interleave * VecT::pixels;
+
+	VecT	m_b0, m_b2, m_b3;
+
+	// y = b0 * x + b1 * y1 + b2 * y2 + b3 * y3, where b1 = 1 - b0 - b2 - b3, so
+	// y = y1 + b0 * (x - y1) + b2 * (y2 - y1) + b3 * (y3 - y1).
+	// Only small differences are scaled, so float is enough even for big radius (b0 -> 0, b1 -> 3).
+	VecT iir( const VecT & x, const VecT & y1, const VecT & y2, const VecT & y3 ) const {
+		VecT t = VecT::madd( m_b3, y3 - y1, m_b2 * (y2 - y1) );
+		t = VecT::madd( m_b0, x - y1, t );
+		return t + y1;
+	}
+
+	//   p_line - points to begin of the first line
+	//      len - length of lines
+	//  advance - '1' for rows or 'stride' for columns
+	//     step - distance between lines: 'stride' for rows or '1' for columns
+	//  n_lines - number of real lines, others repeat the last one
+	//    p_buf - 'len * Interleave' values for forward pass result
+	template <typename PixelT>
+	void do_lines( PixelT * p_line, int len, int advance, int step, int n_lines, VecT * __restrict p_buf ) const {
+		int offset[Interleave];	// Offset of the first pixel of lane
+		int second[Interleave];	// Offset of the second pixel from the first one
+		for ( int k = 0; k < Interleave; k++ ) {
+			int i = std::min( k * VecT::pixels, n_lines - 1 );
+			offset[k] = i * step;
+			second[k] = (std::min( k * VecT::pixels + 1, n_lines - 1 ) - i) * step;
+		}
+
+		VecT y1[Interleave], y2[Interleave], y3[Interleave];
+
+		// Forward pass, history is the first pixel...
+		for ( int k = 0; k < Interleave; k++ ) {
+			y1[k] = y2[k] = y3[k] = VecT::load( p_line + offset[k], second[k] );
+		}
+
+		PixelT * p = p_line;
+		VecT * p_out = p_buf;
+		for ( int i = 0; i < len; i++ ) {
+			for ( int k = 0; k < Interleave; k++ ) {
+				VecT y = iir( VecT::load( p + offset[k], second[k] ), y1[k], y2[k], y3[k] );
+				y3[k] = y2[k];
+				y2[k] = y1[k];
+				y1[k] = y;
+				*p_out++ = y;
+			}
+			p += advance;
+		}
+
+		// Backward pass, history is the last value of forward one...
+		for ( int k = 0; k < Interleave; k++ ) {
+			y1[k] = y2[k] = y3[k] = p_buf[(len - 1) * Interleave + k];
+		}
+
+		for ( int i = len - 1; i >= 0; i-- ) {
+			p -= advance;
+			const VecT * p_in = p_buf + i * Interleave;
+			for ( int k = 0; k < Interleave; k++ ) {
+				VecT y = iir( p_in[k], y1[k], y2[k], y3[k] );
+				y3[k] = y2[k];
+				y2[k] = y1[k];
+				y1[k] = y;
+				y.store( p + offset[k], second[k] );
+			}
+		}
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, float radius, int override_num_threads ) {
+		if ( image.width() < 3 || image.height() < 3 ) return;
+		if ( radius < 0.62f ) return;
+
+		// Calculated in double, 'b0' is close to 0 for big radius.
+		double b0, b1, b2, b3;
+		calc_coefficients( double(radius), b0, b1, b2, b3 );
+		m_b0 = b0;
+		m_b2 = b2;
+		m_b3 = b3;
+
+		// Pixels of any format...
+		pixel::visit( image.format(), [&]( auto tag ) {
+			using PixelT = decltype(tag);
+
+			int w = image.width();
+			int h = image.height();
+			int stride = image.stride() / int(sizeof( PixelT ));
+
+			// Horizontal pass (groups of rows)...
+			parallel_for.run_and_wait( 0, (h + lines - 1) / lines, [&]( int a, int b ) {
+				std::unique_ptr <VecT[]> buf( new (std::nothrow) VecT [size_t(w) * Interleave] );
+				if ( !buf ) {
+					std::fprintf( stderr, "%s: couldn't allocate buffer.\n", __FUNCTION__ );
+					return;
+				}
+
+				for ( int i = a; i < b; i++ ) {
+					int y = i * lines;
+					do_lines( (PixelT *)image.row_ptr( y ), w, 1, stride, std::min( lines, h - y ), buf.get() );
+				}
+			}, override_num_threads );
+
+			// Vertical pass (groups of adjacent columns)...
+			parallel_for.run_and_wait( 0, (w + lines - 1) / lines, [&]( int a, int b ) {
+				std::unique_ptr <VecT[]> buf( new (std::nothrow) VecT [size_t(h) * Interleave] );
+				if ( !buf ) {
+					std::fprintf( stderr, "%s: couldn't allocate buffer.\n", __FUNCTION__ );
+					return;
+				}
+
+				for ( int i = a; i < b; i++ ) {
+					int x = i * lines;
+					do_lines( (PixelT *)image.col_ptr( x ), h, stride, 1, std::min( lines, w - x ), buf.get() );
+				}
+			}, override_num_threads );
+		} );
+	}
+}; // class simd
+
+} // namespace san::blur::recursive
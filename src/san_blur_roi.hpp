@@ -0,0 +1,89 @@
+#pragma once
+
+namespace san::blur::roi {
+
+// Sub-rectangle of image
+struct rect {
+	int		x = 0;
+	int		y = 0;
+	int		w = 0;
+	int		h = 0;
+
+	// Intersection with 'width' x 'height' image
+	rect clipped( int width, int height ) const {
+		int x0 = std::max( x, 0 ), x1 = std::min( x + w, width  );
+		int y0 = std::max( y, 0 ), y1 = std::min( y + h, height );
+		return { x0, y0, std::max( x1 - x0, 0 ), std::max( y1 - y0, 0 ) };
+	}
+
+	// Grown by 'n' on each side
+	rect expanded( int n ) const { return { x - n, y - n, w + n * 2, h + n * 2 }; }
+
+	bool empty() const { return w <= 0 || h <= 0; }
+}; // struct rect
+
+// Copies 'r' of 'src' to the top left corner of 'dst' ('*_x', '*_y' - positions of 'r' in both).
+template <typename SrcViewT, typename DstViewT, typename ParallelForT>
+void copy_rect( const SrcViewT & src, int src_x, int src_y, DstViewT & dst, int dst_x, int dst_y, int w, int h,
+	ParallelForT & parallel_for, int override_num_threads )
+{
+	assert( src.bytes_per_pixel() == dst.bytes_per_pixel() );
+	const size_t bytes = size_t(w) * src.bytes_per_pixel();
+	parallel_for.run_and_wait( 0, h, [&]( int a, int b ) {
+		for ( int y = a; y < b; y++ ) {
+			std::memcpy( dst.pix_ptr( dst_x, dst_y + y ), src.pix_ptr( src_x, src_y + y ), bytes );
+		}
+	}, override_num_threads );
+}
+
+// Blur of region of interest (e.g. panel behind a dialog), cost scales with its area instead of image one.
+// 'BlurT' blurs the rectangle expanded by halo (clipped by image bounds) in aligned scratch surface, then only
+// the rectangle is copied back, so pixels outside of it are read, but never written.
+// Pixels of the rectangle are the same as after blur of whole image, if kernel of 'BlurT' doesn't reach further
+// than halo: stack and gaussian 'kernel_cache' ones do with 'HaloPercent' = 100 ('box::cascaded' reaches a bit further,
+// error is within a level). Recursive (IIR) response is infinite, 'HaloPercent' = 150 (3 sigmas) keeps it within a level.
+// Both passes of 'BlurT' are parallel over rows and columns of the scratch.
+template <typename BlurT, int HaloPercent = 100>
+class clipped {
+	static_assert( HaloPercent >= 0 );
+
+	BlurT	m_blur;
+	rect	m_rect;	// Used by 'operator ()'
+
+public:
+	clipped( const rect & r, const BlurT & blur = BlurT() ) : m_blur( blur ), m_rect( r ) {}
+
+	void set_rect( const rect & r ) { m_rect = r; }
+	const rect & get_rect() const { return m_rect; }
+
+	template <typename ImageViewT, typename ParallelForT>
+	void blur( ImageViewT & image, ParallelForT & parallel_for, const rect & r, float radius, int override_num_threads ) {
+		if ( !(radius > 0.f) ) return;
+
+		rect roi = r.clipped( image.width(), image.height() );
+		if ( roi.empty() ) return;
+
+		int halo = int(std::ceil( radius * HaloPercent / 100.f ));
+		rect src = roi.expanded( halo ).clipped( image.width(), image.height() );
+
+		san::surface scratch( src.w, src.h, image.components(), image.format() );
+		if ( !scratch ) {
+			std::fprintf( stderr, "%s: couldn't allocate scratch surface.\n", __FUNCTION__ );
+			return;
+		}
+
+		copy_rect( image, src.x, src.y, scratch, 0, 0, src.w, src.h, parallel_for, override_num_threads );
+
+		san::surface_view view( scratch );
+		m_blur( view, parallel_for, radius, override_num_threads );
+
+		copy_rect( scratch, roi.x - src.x, roi.y - src.y, image, roi.x, roi.y, roi.w, roi.h, parallel_for, override_num_threads );
+	}
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, float radius, int override_num_threads ) {
+		blur( image, parallel_for, m_rect, radius, override_num_threads );
+	}
+}; // class clipped
+
+} // namespace san::blur::roi
@@ -0,0 +1,191 @@
+#pragma once
+
+namespace san::blur::sat {
+
+// Summed-area table of 32bpp image: entry (x, y) is sum of pixels of [0; x) x [0; y), four 32-bit sums in '__m128i'.
+// Sums wrap around, but differences are modular too, so any box sum is exact while it fits in 32 bits,
+// i.e. box area is less than 2^32 / 255 pixels (~16.8 Mpx, box of 4095 x 4095).
+// Requires SSE4.1.
+class table {
+	int			m_width		= 0;
+	int			m_height	= 0;
+	size_t		m_capacity	= 0;
+	__m128i *	m_data		= nullptr;
+
+	__m128i * row( int y ) { return m_data + size_t(y) * pitch(); }
+
+public:
+	table() = default;
+	table( const table & ) = delete;
+	table & operator = ( const table & ) = delete;
+
+	~table() { delete [] m_data; }
+
+	int width()  const { return m_width; }
+	int height() const { return m_height; }
+
+	// Entries per row of table
+	size_t pitch() const { return size_t(m_width) + 1; }
+
+	// Row 'y' (0...height): sums of image rows above 'y'. Entry 'x' of it (0...width) - sum of [0; x) x [0; y).
+	const __m128i * row( int y ) const { return m_data + size_t(y) * pitch(); }
+
+	// Sum of pixels of [x0; x1) x [y0; y1)
+	__m128i sum( int x0, int y0, int x1, int y1 ) const {
+		const __m128i * p0 = row( y0 );
+		const __m128i * p1 = row( y1 );
+		return _mm_add_epi32( _mm_sub_epi32( p1[x1], p1[x0] ), _mm_sub_epi32( p0[x0], p0[x1] ) );
+	}
+
+	// Builds table of 'image'. Memory is reused if table is big enough.
+	// Rows are split into bands, two-level prefix scan:
+	//  1. Every band is summed up on its own (in parallel).
+	//  2. Last rows of bands are accumulated from top to bottom, so they become complete (serial, one row per band).
+	//  3. Other rows of every band get complete last row of the previous band (in parallel).
+	template <typename ImageViewT, typename ParallelForT>
+	bool build( const ImageViewT & image, ParallelForT & parallel_for, int override_num_threads ) {
+		assert( image.components() == 4 );
+
+		m_width  = image.width();
+		m_height = image.height();
+
+		size_t size = pitch() * (size_t(m_height) + 1);
+		if ( size > m_capacity ) {
+			delete [] m_data;
+			m_data = new (std::nothrow) __m128i [size];
+			m_capacity = m_data ? size : 0;
+			if ( !m_data ) {
+				std::fprintf( stderr, "%s: couldn't allocate table.\n", __FUNCTION__ );
+				m_width = m_height = 0;
+				return false;
+			}
+		}
+
+		const int w = m_width;
+		const int h = m_height;
+		const __m128i zero = _mm_setzero_si128();
+		std::fill( row( 0 ), row( 0 ) + pitch(), zero );
+		if ( h < 1 ) return true;	// Zero row only, bands need at least one image row
+
+		int n_threads = override_num_threads > 0 ? override_num_threads : parallel_for.num_threads();
+		int n_bands = std::clamp( n_threads * 4, 1, h );
+		auto band_begin = [&]( int i ) { return int(int64_t(h) * i / n_bands); };
+
+		// 1. Table rows 'y0 + 1...y1' of band, as if rows above band were zero...
+		parallel_for.run_and_wait( 0, n_bands, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				int y_end = band_begin( i + 1 );
+				for ( int y = band_begin( i ); y < y_end; y++ ) {
+					const uint32_t * p_src = (const uint32_t *)image.row_ptr( y );
+					const __m128i * p_up = y == band_begin( i ) ? nullptr : row( y );
+					__m128i * p_dst = row( y + 1 );
+
+					__m128i run = zero;
+					p_dst[0] = zero;
+					for ( int x = 0; x < w; x++ ) {
+						run = _mm_add_epi32( run, _mm_cvtepu8_epi32( _mm_cvtsi32_si128( p_src[x] ) ) );
+						p_dst[x + 1] = p_up ? _mm_add_epi32( run, p_up[x + 1] ) : run;
+					}
+				}
+			}
+		}, override_num_threads );
+
+		// 2. Last rows of bands...
+		for ( int i = 1; i < n_bands; i++ ) {
+			const __m128i * p_up = row( band_begin( i ) );
+			__m128i * p = row( band_begin( i + 1 ) );
+			for ( int x = 1; x <= w; x++ ) p[x] = _mm_add_epi32( p[x], p_up[x] );
+		}
+
+		// 3. The rest of rows...
+		parallel_for.run_and_wait( 1, n_bands, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				const __m128i * p_up = row( band_begin( i ) );
+				int y_last = band_begin( i + 1 );
+				for ( int y = band_begin( i ) + 1; y < y_last; y++ ) {
+					__m128i * p = row( y );
+					for ( int x = 1; x <= w; x++ ) p[x] = _mm_add_epi32( p[x], p_up[x] );
+				}
+			}
+		}, override_num_threads );
+
+		return true;
+	}
+}; // class table
+
+
+// Blurs every pixel of 'image' with box of radius 'radius_at( x, y )' looked up in 'sat' (built from the same image).
+// Boxes are clipped by image borders and normalized by clipped area.
+template <typename ImageViewT, typename ParallelForT, typename RadiusF>
+void blur_boxes( const table & sat, ImageViewT & image, ParallelForT & parallel_for, RadiusF && radius_at, int override_num_threads ) {
+	assert( image.components() == 4 );
+	assert( sat.width() == image.width() && sat.height() == image.height() );
+
+	const int w = image.width();
+	const int h = image.height();
+
+	parallel_for.run_and_wait( 0, h, [&]( int a, int b ) {
+		for ( int y = a; y < b; y++ ) {
+			uint32_t * p_dst = (uint32_t *)image.row_ptr( y );
+			for ( int x = 0; x < w; x++ ) {
+				int r = radius_at( x, y );
+				int x0 = std::max( x - r, 0 ), x1 = std::min( x + r + 1, w );
+				int y0 = std::max( y - r, 0 ), y1 = std::min( y + r + 1, h );
+
+				// Sums are less than 2^31 for allowed radii, so signed conversion is fine.
+				__m128 s = _mm_cvtepi32_ps( sat.sum( x0, y0, x1, y1 ) );
+				__m128i v = _mm_cvtps_epi32( _mm_mul_ps( s, _mm_set1_ps( 1.f / float((x1 - x0) * (y1 - y0)) ) ) );
+				v = _mm_packus_epi32( v, v );
+				p_dst[x] = _mm_cvtsi128_si32( _mm_packus_epi16( v, v ) );
+			}
+		}
+	}, override_num_threads );
+}
+
+
+// Box area * 255 must fit in 31 bits (see 'blur_boxes').
+constexpr int max_radius = 1024;
+
+
+// Blur with radius which changes from pixel to pixel (depth of field, vignette, tilt-shift...).
+// Radius of pixel is the first component of the same pixel of 'radius_map' times 'scale'.
+// Table is kept between calls, so it's not reallocated for every frame.
+class variable {
+	table	m_table;
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, const san::surface & radius_map, float scale, ParallelForT & parallel_for, int override_num_threads ) {
+		if ( image.width() < 1 || image.height() < 1 ) return;
+		if ( radius_map.width() != image.width() || radius_map.height() != image.height() ) {
+			std::fprintf( stderr, "%s: radius map size doesn't match image size.\n", __FUNCTION__ );
+			return;
+		}
+
+		if ( !m_table.build( image, parallel_for, override_num_threads ) ) return;
+
+		const int map_components = radius_map.components();
+		blur_boxes( m_table, image, parallel_for, [&]( int x, int y ) {
+			int r = int(radius_map.row_ptr( y )[x * map_components] * scale + .5f);
+			return std::clamp( r, 0, max_radius );
+		}, override_num_threads );
+	}
+}; // class variable
+
+
+// Constant radius box blur through summed-area table. One box, so it's not a gaussian approximation,
+// but cost doesn't depend on radius. Mostly to check and benchmark table with other implementations.
+class box {
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( radius < 1 || image.width() < 1 || image.height() < 1 ) return;
+		radius = std::min( radius, max_radius );
+
+		table t;
+		if ( !t.build( image, parallel_for, override_num_threads ) ) return;
+		blur_boxes( t, image, parallel_for, [radius]( int, int ) { return radius; }, override_num_threads );
+	}
+}; // class box
+
+} // namespace san::blur::sat
@@ -2,24 +2,53 @@
 
 namespace san::blur::stack {
 
-const uint16_t lut_mul[255] = {
-	512,512,456,512,328,456,335,512,405,328,271,456,388,335,292,512, 454,405,364,328,298,271,496,456,420,388,360,335,312,292,273,512,
-	482,454,428,405,383,364,345,328,312,298,284,271,259,496,475,456, 437,420,404,388,374,360,347,335,323,312,302,292,282,273,265,512,
-	497,482,468,454,441,428,417,405,394,383,373,364,354,345,337,328, 320,312,305,298,291,284,278,271,265,259,507,496,485,475,465,456,
-	446,437,428,420,412,404,396,388,381,374,367,360,354,347,341,335, 329,323,318,312,307,302,297,292,287,282,278,273,269,265,261,512,
-	505,497,489,482,475,468,461,454,447,441,435,428,422,417,411,405, 399,394,389,383,378,373,368,364,359,354,350,345,341,337,332,328,
-	324,320,316,312,309,305,301,298,294,291,287,284,281,278,274,271, 268,265,262,259,257,507,501,496,491,485,480,475,470,465,460,456,
-	451,446,442,437,433,428,424,420,416,412,408,404,400,396,392,388, 385,381,377,374,370,367,363,360,357,354,350,347,344,341,338,335,
-	332,329,326,323,320,318,315,312,310,307,304,302,299,297,294,292, 289,287,285,282,280,278,275,273,271,269,267,265,263,261,259 };
-
-const uint8_t lut_shr[255] = {
-	 9, 11, 12, 13, 13, 14, 14, 15, 15, 15, 15, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17, 18, 18, 18, 18, 18, 18, 18, 18, 18, 19, 
-	19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 19, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 21,
-	21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 22, 22, 22, 22, 22, 22, 
-	22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 22, 23, 
-	23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23,
-	23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 
-	24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
-	24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24 };
+// Sum of stack of radius 'r' is divided by '(r + 1)^2' as 'sum * lut_mul[r] >> lut_shr[r]'.
+// 'lut_shr[r]' is the smallest shift with '2^shr > 256 * (r + 1)^2', so multiplier is in (256; 512]
+// and error is less than one for any sum of 8-bit values. Tables are generated at compile time.
+// 'lut16_mul' and 'lut16_shr' are the same for sums of 16-bit values ('2^shr > 65536 * (r + 1)^2').
+constexpr int lut_max_radius = 2048;
+
+namespace detail {
+
+template <int Bits>
+constexpr uint8_t lut_shift( int radius ) {
+	uint64_t d = uint64_t(radius + 1) * (radius + 1);
+	uint8_t shr = 0;
+	while ( (uint64_t(1) << shr) <= (uint64_t(1) << Bits) * d ) shr++;
+	return shr;
+}
+
+template <typename MulT, int Bits>
+constexpr std::array <MulT, lut_max_radius + 1> make_lut_mul() {
+	std::array <MulT, lut_max_radius + 1> lut = {};
+	for ( int r = 0; r <= lut_max_radius; r++ ) {
+		uint64_t d = uint64_t(r + 1) * (r + 1);
+		lut[r] = MulT(((uint64_t(1) << lut_shift<Bits>( r )) + d - 1) / d);	// Rounded up
+	}
+	return lut;
+}
+
+template <int Bits>
+constexpr std::array <uint8_t, lut_max_radius + 1> make_lut_shr() {
+	std::array <uint8_t, lut_max_radius + 1> lut = {};
+	for ( int r = 0; r <= lut_max_radius; r++ ) lut[r] = lut_shift<Bits>( r );
+	return lut;
+}
+
+} // namespace detail
+
+constexpr std::array <uint16_t, lut_max_radius + 1>	lut_mul		= detail::make_lut_mul<uint16_t, 8>();
+constexpr std::array <uint8_t,  lut_max_radius + 1>	lut_shr		= detail::make_lut_shr<8>();
+
+constexpr std::array <uint32_t, lut_max_radius + 1>	lut16_mul	= detail::make_lut_mul<uint32_t, 16>();
+constexpr std::array <uint8_t,  lut_max_radius + 1>	lut16_shr	= detail::make_lut_shr<16>();
+
+// Values of former hand-written tables
+static_assert( lut_mul[  0] == 512 && lut_shr[  0] ==  9 );
+static_assert( lut_mul[  2] == 456 && lut_shr[  2] == 12 );
+static_assert( lut_mul[ 22] == 496 && lut_shr[ 22] == 18 );
+static_assert( lut_mul[254] == 259 && lut_shr[254] == 24 );
+
+static_assert( lut16_mul[lut_max_radius] <= (1 << 17) && lut16_shr[lut_max_radius] < 40 );
 
 } // namespace san::blur::stack
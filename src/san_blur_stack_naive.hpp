@@ -2,16 +2,18 @@
 
 namespace san::blur::stack {
 
-template <typename NaiveCalcT>
-void naive_do_line( adaptor::straight_line & line, int beg, int end/*exclusive*/, int radius ) {
+// 'LineT' - line adaptor ('adaptor::basic_straight_line', 'adaptor::basic_sheared_line')
+template <typename NaiveCalcT, typename LineT>
+void naive_do_line( LineT & line, int beg, int end/*exclusive*/, int radius ) {
+	using PixelT = typename LineT::pixel_type;
 	int den = radius * (radius + 2) + 1;
 	int div = radius * 2 + 1;
-	uint32_t * p_stack = (uint32_t *)SAN_STACK_ALLOC( sizeof( uint32_t ) * div );
+	PixelT * p_stack = (PixelT *)SAN_STACK_ALLOC( sizeof( PixelT ) * div );
 
 	// Fill initial stack...
 	NaiveCalcT sum, sum_in, sum_out;
 	for ( int i = -radius; i <= radius; i++ ) {
-		uint32_t c = line.get_pix( beg + i );
+		PixelT c = line.get_pix( beg + i );
 		p_stack[i + radius] = c;
 		sum += NaiveCalcT( c ) * (radius - std::abs( i ) + 1);
 		if ( i <= 0 ) {
@@ -25,7 +27,7 @@ void naive_do_line( adaptor::straight_line & line, int beg, int end/*exclusive*/
 
 	line.set_pix_start( beg );
 	for ( int i = beg; i < end; i++ ) {
-		line.set_pix_next( uint32_t( sum / den ) );
+		line.set_pix_next( PixelT( sum / den ) );
 
 		sum -= sum_out;
 
@@ -34,7 +36,7 @@ void naive_do_line( adaptor::straight_line & line, int beg, int end/*exclusive*/
 
 		sum_out -= p_stack[stack_start];
 
-		uint32_t c = line.get_pix( i + radius + 1 );
+		PixelT c = line.get_pix( i + radius + 1 );
 
 		p_stack[stack_start] = c;
 		sum_in += c;
@@ -49,14 +51,16 @@ void naive_do_line( adaptor::straight_line & line, int beg, int end/*exclusive*/
 	}
 }
 
-template <typename NaiveCalcT, typename ParallelForT>
+// 'PixelT' - pixel type of image (see 'san_pixel.hpp'), 'NaiveCalcT' must hold sums of its components.
+template <typename NaiveCalcT, typename ParallelForT, typename PixelT = uint32_t>
 void naive( san::surface_view & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
 	if ( radius <= 0 ) return;
+	assert( image.bytes_per_pixel() == sizeof( PixelT ) );
 
 	// Horizontal pass...
 	parallel_for.run_and_wait( 0, image.height(), [&]( int a, int b ) {
 		for ( int y = a; y < b; y++ ) {
-			adaptor::straight_line line( (uint32_t *)image.row_ptr( y ), image.width(), 1 );
+			adaptor::basic_straight_line <PixelT> line( (PixelT *)image.row_ptr( y ), image.width(), 1 );
 			naive_do_line<NaiveCalcT>( line, 0, image.width(), radius );
 		}
 	}, override_num_threads );
@@ -64,7 +68,7 @@ void naive( san::surface_view & image, ParallelForT & parallel_for, int radius,
 	// Vertical pass...
 	parallel_for.run_and_wait( 0, image.width(), [&]( int a, int b ) {
 		for ( int x = a; x < b; x++ ) {
-			adaptor::straight_line line( (uint32_t *)image.col_ptr( x ), image.height(), image.stride() / image.components() );
+			adaptor::basic_straight_line <PixelT> line( (PixelT *)image.col_ptr( x ), image.height(), image.stride() / int(sizeof( PixelT )) );
 			naive_do_line<NaiveCalcT>( line, 0, image.height(), radius );
 		}
 	}, override_num_threads );
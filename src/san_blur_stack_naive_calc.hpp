@@ -33,6 +33,15 @@ public:
 			    (c[0] & 0xff);
 	}
 
+	// 16-bit and half-float pixels (see 'san_pixel.hpp'). 'ValueT' must hold their sums: 'int64_t' or floating point.
+	naive_calc( const pixel::rgba16 & value ) { pixel::unpack( value, c ); }
+	explicit operator pixel::rgba16 () const { return pixel::pack<pixel::rgba16>( c ); }
+
+#if defined( SAN_PIXEL_F16C )
+	naive_calc( const pixel::rgba16f & value ) { pixel::unpack( value, c ); }
+	explicit operator pixel::rgba16f () const { return pixel::pack<pixel::rgba16f>( c ); }
+#endif
+
 	naive_calc & operator = ( uint32_t value ) {
 		c[3] = (value >> 24) & 0xff;
 		c[2] = (value >> 16) & 0xff;
@@ -57,20 +66,23 @@ public:
 		return *this;
 	}
 
-	naive_calc operator * ( ValueT value ) const {
+	// Templates, so 'int' argument is exact match for any 'ValueT' and built-in operators (through 'uint32_t') aren't ambiguous.
+	template <typename T>
+	naive_calc operator * ( T value ) const {
 		return naive_calc(
-			c[0] * value,
-			c[1] * value,
-			c[2] * value,
-			c[3] * value );
+			c[0] * ValueT(value),
+			c[1] * ValueT(value),
+			c[2] * ValueT(value),
+			c[3] * ValueT(value) );
 	}
 
-	naive_calc operator / ( ValueT value ) const {
+	template <typename T>
+	naive_calc operator / ( T value ) const {
 		return naive_calc(
-			c[0] / value,
-			c[1] / value,
-			c[2] / value,
-			c[3] / value );
+			c[0] / ValueT(value),
+			c[1] / ValueT(value),
+			c[2] / ValueT(value),
+			c[3] / ValueT(value) );
 	}
 
 #if 0
@@ -85,4 +97,10 @@ public:
 #endif
 }; // struct naive_calc
 
+// Sums of radius above ~2900 overflow 'int'. Also for 16-bit pixels.
+using naive_calc_wide = naive_calc <int64_t>;
+
+// For half-float pixels
+using naive_calc_float = naive_calc <double>;
+
 } // namespace san::blur::stack
@@ -0,0 +1,102 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Image and radius of one job of 'batched::run()'
+template <typename ImageViewT>
+struct batch_job {
+	ImageViewT *	p_image;
+	int				radius;
+};
+
+// Aggregate of 'batched::run()'
+struct batch_stats {
+	int			jobs	= 0;	// Blurred ones (radius and image size aren't zero)
+	int64_t		pixels	= 0;	// Of blurred images
+	double		ms		= 0;	// Both passes
+
+	double mpix_s() const { return ms > 0. ? double(pixels) / (ms * 1000.) : 0.; }
+};
+
+// 'tiled' for many small images (thumbnails, icons, sprites). Fork/join per image costs more than blur of it,
+// so rows of all images are one flattened range of 'parallel_for' and strips of columns are the other:
+// two fork/joins for the whole batch instead of two per image.
+template <typename CalcT, int Columns = 16>
+class batched : public tiled <CalcT, Columns> {
+	using pixel_t = typename optimized_2 <CalcT>::pixel_t;
+
+	// Index of job that flattened item 'i' belongs to ('p_first' - first items of jobs and total count)
+	static int job_of( const int * p_first, int n_jobs, int i ) {
+		return int(std::upper_bound( p_first, p_first + n_jobs + 1, i ) - p_first) - 1;
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	batch_stats run( const batch_job <ImageViewT> * p_jobs, int n_jobs, ParallelForT & parallel_for, int override_num_threads ) {
+		batch_stats stats;
+		if ( n_jobs <= 0 ) return stats;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		// Parameters of radius of every job, first rows and first strips of jobs in flattened ranges...
+		std::unique_ptr <batched[]> engines( new (std::nothrow) batched [n_jobs] );
+		std::unique_ptr <int[]> first( new (std::nothrow) int [(n_jobs + 1) * 2] );
+		if ( !engines || !first ) {
+			std::fprintf( stderr, "%s: couldn't allocate %d jobs.\n", __FUNCTION__, n_jobs );
+			return stats;
+		}
+
+		int * p_first_row   = first.get();
+		int * p_first_strip = p_first_row + n_jobs + 1;
+		p_first_row[0] = p_first_strip[0] = 0;
+
+		for ( int j = 0; j < n_jobs; j++ ) {
+			const ImageViewT & image = *p_jobs[j].p_image;
+			assert( image.bytes_per_pixel() == sizeof( pixel_t ) );
+
+			int w = image.width();
+			int h = image.height();
+			bool active = w > 0 && h > 0 && engines[j].set_radius( p_jobs[j].radius );
+			p_first_row[j + 1]   = p_first_row[j]   + (active ? h : 0);
+			p_first_strip[j + 1] = p_first_strip[j] + (active ? w / Columns + w % Columns : 0);
+
+			if ( active ) {
+				stats.jobs++;
+				stats.pixels += int64_t(w) * h;
+			}
+		}
+
+		// Horizontal pass (rows of all images)...
+		parallel_for.run_and_wait( 0, p_first_row[n_jobs], [&]( int a, int b ) {
+			int j = job_of( p_first_row, n_jobs, a );
+			for ( int i = a; i < b; i++ ) {
+				while ( i >= p_first_row[j + 1] ) j++;
+				const ImageViewT & image = *p_jobs[j].p_image;
+				engines[j].do_line( (pixel_t *)image.row_ptr( i - p_first_row[j] ), image.width(), 1 );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (strips of columns of all images, remaining columns one by one)...
+		parallel_for.run_and_wait( 0, p_first_strip[n_jobs], [&]( int a, int b ) {
+			int j = job_of( p_first_strip, n_jobs, a );
+			for ( int i = a; i < b; i++ ) {
+				while ( i >= p_first_strip[j + 1] ) j++;
+				const ImageViewT & image = *p_jobs[j].p_image;
+				int w = image.width();
+				int n_strips = w / Columns;
+				int k = i - p_first_strip[j];
+				int advance = image.stride() / int(sizeof( pixel_t ));
+				if ( k < n_strips ) {
+					engines[j].template do_strip<Columns>( (pixel_t *)image.col_ptr( k * Columns ), image.height(), advance );
+				} else {
+					engines[j].template do_strip<1>( (pixel_t *)image.col_ptr( n_strips * Columns + k - n_strips ), image.height(), advance );
+				}
+			}
+		}, override_num_threads );
+
+		stats.ms = std::chrono::duration <double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+		return stats;
+	}
+}; // class batched
+
+} // namespace san::blur::stack::simd
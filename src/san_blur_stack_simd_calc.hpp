@@ -60,6 +60,10 @@ class sse128_u32_t {
 	__m128i m_vec;
 
 public:
+	using pixel_type = uint32_t;
+	static constexpr int max_radius = 254;	// 'sum * lut_mul[radius]' fits in 32 bits
+	static constexpr int lut_bits = 8;		// 'lut_mul' and 'lut_shr' (or 'lut16_*' for 16)
+
 	sse128_u32_t() : m_vec( _mm_setzero_si128() ) {}
 
 	sse128_u32_t( const __m128i & v ) : m_vec( v ) {}
@@ -145,4 +149,302 @@ public:
 	}
 }; // class sse128_u32_t
 
+
+// Product of 32-bit lanes and 'int'. It's calculated when it's known what is needed:
+// low dwords ('sum = v * n') or whole 64-bit products shifted right ('sum * mul >> shr'). Requires SSE4.1.
+template <typename CalcT>
+class sse128_u32_product {
+	__m128i	m_a;
+	int		m_b;
+
+public:
+	sse128_u32_product( const __m128i & a, int b ) : m_a( a ), m_b( b ) {}
+
+	operator CalcT () const {
+		return CalcT( _mm_mullo_epi32( m_a, _mm_set1_epi32( m_b ) ) );
+	}
+
+	CalcT operator >> ( uint8_t shift ) const {
+		__m128i b = _mm_set1_epi32( m_b );
+		__m128i count = _mm_cvtsi32_si128( shift );
+		__m128i even = _mm_srl_epi64( _mm_mul_epu32( m_a, b ), count );						// Dwords 0, 2
+		__m128i odd  = _mm_srl_epi64( _mm_mul_epu32( _mm_srli_epi64( m_a, 32 ), b ), count );	// Dwords 1, 3
+		return CalcT( _mm_blend_epi16( even, _mm_slli_epi64( odd, 32 ), 0xcc ) );
+	}
+}; // class sse128_u32_product
+
+
+// 'sse128_u32_t<41>' for radius up to 'lut_max_radius'. Sums still fit in 32 bits (255 * 2049^2 < 2^30),
+// but 'sum * lut_mul[radius]' doesn't, so it's calculated in 64 bits and shifted back to 32.
+class sse128_u32_wide_t : public sse128_u32_t<41> {
+	using base = sse128_u32_t<41>;
+
+public:
+	static constexpr int max_radius = lut_max_radius;
+
+	using base::base;
+
+	sse128_u32_wide_t() = default;
+	sse128_u32_wide_t( const base & v ) : base( v ) {}
+
+	sse128_u32_product <sse128_u32_wide_t> operator * ( int value ) const {
+		return { *this, value };
+	}
+}; // class sse128_u32_wide_t
+
+
+// 16-bit pixels ('pixel::rgba16'), radius up to 254: sums fit in 32 bits (65535 * 255^2 < 2^32).
+// Divided by 17-bit 'lut16_mul' in 64 bits, as in 'sse128_u32_wide_t', so the result is as precise as for 8-bit pixels.
+class sse128_u32_rgba16_t : public sse128_u32_t<41> {
+	using base = sse128_u32_t<41>;
+
+public:
+	using pixel_type = pixel::rgba16;
+	static constexpr int max_radius = 254;
+	static constexpr int lut_bits = 16;
+
+	sse128_u32_rgba16_t() = default;
+	sse128_u32_rgba16_t( const __m128i & v ) : base( v ) {}
+	sse128_u32_rgba16_t( const base & v ) : base( v ) {}
+	sse128_u32_rgba16_t( const pixel::rgba16 & p ) : base( _mm_cvtepu16_epi32( _mm_loadl_epi64( (const __m128i *)&p ) ) ) {}
+
+	operator pixel::rgba16 () const {
+		pixel::rgba16 p;
+		_mm_storel_epi64( (__m128i *)&p, _mm_packus_epi32( *this, *this ) );
+		return p;
+	}
+
+	// Own operators, so pixels are converted implicitly
+	sse128_u32_rgba16_t & operator += ( const sse128_u32_rgba16_t & rhs ) {
+		base::operator += ( rhs );
+		return *this;
+	}
+
+	sse128_u32_rgba16_t & operator -= ( const sse128_u32_rgba16_t & rhs ) {
+		base::operator -= ( rhs );
+		return *this;
+	}
+
+	sse128_u32_product <sse128_u32_rgba16_t> operator * ( int value ) const {
+		return { *this, value };
+	}
+}; // class sse128_u32_rgba16_t
+
+
+// Two 32bpp pixels at once in 16-bit lanes, packed as 'uint64_t': low dword - first pixel, high dword - second.
+// Sums fit in 16 bits for radius up to 14 (255 * 15^2 = 57375). 'sum * lut_mul >> lut_shr' is the high half of
+// 16x16-bit product: 'lut_shr' is at most 16 there, so 'lut_mul << (16 - lut_shr)' is exact. Requires SSE4.1.
+class sse128_u16_t {
+	__m128i m_vec;
+
+public:
+	using packed_type = uint64_t;
+	static constexpr int pixels = 2;
+	static constexpr int max_radius = 14;
+
+	sse128_u16_t() : m_vec( _mm_setzero_si128() ) {}
+
+	sse128_u16_t( const __m128i & v ) : m_vec( v ) {}
+
+	sse128_u16_t( uint64_t v ) : m_vec( _mm_cvtepu8_epi16( _mm_cvtsi64_si128( v ) ) ) {}
+
+	operator __m128i () const { return m_vec; }
+
+	operator uint64_t () const {
+		return _mm_cvtsi128_si64( _mm_packus_epi16( m_vec, m_vec ) );
+	}
+
+	sse128_u16_t & operator += ( const sse128_u16_t & rhs ) {
+		m_vec = _mm_add_epi16( m_vec, rhs );
+		return *this;
+	}
+
+	sse128_u16_t & operator -= ( const sse128_u16_t & rhs ) {
+		m_vec = _mm_sub_epi16( m_vec, rhs );
+		return *this;
+	}
+
+	sse128_u16_t operator * ( int value ) const {
+		return _mm_mullo_epi16( m_vec, _mm_set1_epi16( value ) );
+	}
+
+	// 'mul' - 'lut_mul[radius] << (16 - lut_shr[radius])'
+	sse128_u16_t mulhi( uint16_t mul ) const {
+		return _mm_mulhi_epu16( m_vec, _mm_set1_epi16( mul ) );
+	}
+}; // class sse128_u16_t
+
+
+#if defined( SAN_PIXEL_F16C )
+
+// Half-float pixels ('pixel::rgba16f'), four float sums. Running sums aren't exact, but their error is far below
+// precision of half-floats. Divided by 'lut16_mul' and '2^-lut16_shr', both are exact floats. Requires F16C.
+class sse128_f32_rgba16f_t {
+	__m128 m_vec;
+
+public:
+	using pixel_type = pixel::rgba16f;
+	static constexpr int max_radius = lut_max_radius;
+	static constexpr int lut_bits = 16;
+
+	sse128_f32_rgba16f_t() : m_vec( _mm_setzero_ps() ) {}
+	sse128_f32_rgba16f_t( const __m128 & v ) : m_vec( v ) {}
+	sse128_f32_rgba16f_t( const pixel::rgba16f & p ) : m_vec( pixel::load_ps( &p ) ) {}
+
+	operator __m128 () const { return m_vec; }
+
+	operator pixel::rgba16f () const {
+		pixel::rgba16f p;
+		pixel::store_ps( &p, m_vec );
+		return p;
+	}
+
+	sse128_f32_rgba16f_t & operator += ( const sse128_f32_rgba16f_t & rhs ) {
+		m_vec = _mm_add_ps( m_vec, rhs );
+		return *this;
+	}
+
+	sse128_f32_rgba16f_t & operator -= ( const sse128_f32_rgba16f_t & rhs ) {
+		m_vec = _mm_sub_ps( m_vec, rhs );
+		return *this;
+	}
+
+	sse128_f32_rgba16f_t operator * ( int value ) const {
+		return _mm_mul_ps( m_vec, _mm_set1_ps( float(value) ) );
+	}
+
+	// Multiplication by '2^-shift' (exponent of float is built directly)
+	sse128_f32_rgba16f_t operator >> ( uint8_t shift ) const {
+		return _mm_mul_ps( m_vec, _mm_castsi128_ps( _mm_set1_epi32( (127 - shift) << 23 ) ) );
+	}
+}; // class sse128_f32_rgba16f_t
+
+#endif // defined( SAN_PIXEL_F16C )
+
+
+#if defined( __AVX2__ )
+
+// Two 32bpp pixels at once, one per 128-bit half. Packed as 'uint64_t': low dword - first pixel, high dword - second.
+class avx256_u32_t {
+	__m256i m_vec;
+
+public:
+	static constexpr int max_radius = 254;
+
+	avx256_u32_t() : m_vec( _mm256_setzero_si256() ) {}
+
+	avx256_u32_t( const __m256i & v ) : m_vec( v ) {}
+
+	avx256_u32_t( uint64_t v ) : m_vec( _mm256_cvtepu8_epi32( _mm_cvtsi64_si128( v ) ) ) {}
+
+	operator __m256i () const { return m_vec; }
+
+	operator uint64_t () const {
+		__m256i s = _mm256_setr_epi8(
+			0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+			0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 );
+		__m256i v = _mm256_shuffle_epi8( m_vec, s );	// In-lane shuffle, pixel in low dword of each half
+		return _mm_cvtsi128_si64( _mm_unpacklo_epi32( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ) ) );
+	}
+
+	avx256_u32_t & operator += ( const avx256_u32_t & rhs ) {
+		m_vec = _mm256_add_epi32( m_vec, rhs );
+		return *this;
+	}
+
+	avx256_u32_t & operator -= ( const avx256_u32_t & rhs ) {
+		m_vec = _mm256_sub_epi32( m_vec, rhs );
+		return *this;
+	}
+
+	avx256_u32_t operator * ( int value ) const {
+		return _mm256_mullo_epi32( m_vec, _mm256_set1_epi32( value ) );
+	}
+
+	avx256_u32_t operator >> ( uint8_t shift ) const {
+		return _mm256_srli_epi32( m_vec, shift );
+	}
+}; // class avx256_u32_t
+
+// Four 32bpp pixels at once in 16-bit lanes, packed as '__m128i' (see 'sse128_u16_t').
+class avx256_u16_t {
+	__m256i m_vec;
+
+public:
+	using packed_type = __m128i;
+	static constexpr int pixels = 4;
+	static constexpr int max_radius = 14;
+
+	avx256_u16_t() : m_vec( _mm256_setzero_si256() ) {}
+
+	avx256_u16_t( const __m256i & v ) : m_vec( v ) {}
+
+	avx256_u16_t( const __m128i & v ) : m_vec( _mm256_cvtepu8_epi16( v ) ) {}
+
+	operator __m256i () const { return m_vec; }
+
+	operator __m128i () const {
+		return _mm_packus_epi16( _mm256_castsi256_si128( m_vec ), _mm256_extracti128_si256( m_vec, 1 ) );
+	}
+
+	avx256_u16_t & operator += ( const avx256_u16_t & rhs ) {
+		m_vec = _mm256_add_epi16( m_vec, rhs );
+		return *this;
+	}
+
+	avx256_u16_t & operator -= ( const avx256_u16_t & rhs ) {
+		m_vec = _mm256_sub_epi16( m_vec, rhs );
+		return *this;
+	}
+
+	avx256_u16_t operator * ( int value ) const {
+		return _mm256_mullo_epi16( m_vec, _mm256_set1_epi16( value ) );
+	}
+
+	avx256_u16_t mulhi( uint16_t mul ) const {
+		return _mm256_mulhi_epu16( m_vec, _mm256_set1_epi16( mul ) );
+	}
+}; // class avx256_u16_t
+
+#endif // defined( __AVX2__ )
+
+
+// Four 32bpp pixels at once, one per 128-bit quarter. Packed as '__m128i', one pixel per dword.
+// AVX-512 isn't enabled for whole project, so every function using this type must be marked 'SAN_TARGET_AVX512'.
+// Zero-masked forms are used with full mask because GCC 12 gives false '-Wuninitialized' on unmasked ones.
+class avx512_u32_t {
+	__m512i m_vec;
+
+public:
+	static constexpr int max_radius = 254;
+
+	SAN_TARGET_AVX512 avx512_u32_t() : m_vec( _mm512_setzero_si512() ) {}
+
+	SAN_TARGET_AVX512 avx512_u32_t( const __m512i & v ) : m_vec( v ) {}
+
+	SAN_TARGET_AVX512 avx512_u32_t( const __m128i & v ) : m_vec( _mm512_maskz_cvtepu8_epi32( 0xffff, v ) ) {}
+
+	SAN_TARGET_AVX512 operator __m128i () const {
+		return _mm512_maskz_cvtepi32_epi8( 0xffff, m_vec );	// Truncation, values are already in [0;255]
+	}
+
+	SAN_TARGET_AVX512 avx512_u32_t & operator += ( const avx512_u32_t & rhs ) {
+		m_vec = _mm512_add_epi32( m_vec, rhs.m_vec );
+		return *this;
+	}
+
+	SAN_TARGET_AVX512 avx512_u32_t & operator -= ( const avx512_u32_t & rhs ) {
+		m_vec = _mm512_sub_epi32( m_vec, rhs.m_vec );
+		return *this;
+	}
+
+	SAN_TARGET_AVX512 avx512_u32_t operator * ( int value ) const {
+		return _mm512_mullo_epi32( m_vec, _mm512_set1_epi32( value ) );
+	}
+
+	SAN_TARGET_AVX512 avx512_u32_t operator >> ( uint8_t shift ) const {
+		return _mm512_maskz_srl_epi32( 0xffff, m_vec, _mm_cvtsi32_si128( shift ) );
+	}
+}; // class avx512_u32_t
+
 } // namespace san::blur::stack::simd
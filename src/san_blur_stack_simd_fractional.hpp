@@ -0,0 +1,173 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Stack blur of fractional radius, so animated radius changes smoothly. Kernel is a blend of kernels of 'r' and
+// 'r + 1' ('r' - integer part of radius, 't' - fractional one) and both come from one stack walk of radius 'r + 1':
+// stack sum of radius 'r' is the one of 'r + 1' minus box sum of 'r + 1', and that is 'sum_in + sum_out'.
+// So result is '(m_mul_sum * sum - m_mul_box * (sum_in + sum_out)) >> 24', where weights of both kernels and their
+// normalization are in fixed point multipliers. Products may wrap around, but the result fits in 32 bits.
+// Multipliers are rounded down, result may be less than exact one by '(r + 1)^2 / 2^24' of pixel value
+// (less than a level for radius below 64, about one for the biggest ones).
+// Integer radii (and ones clamped to 'CalcT::max_radius') are passed to 'tiled', so 't' == 0 gives exactly
+// the result of integer kernels. 'CalcT' - 'sse128_u32_t'. Layout of passes is the one of 'tiled'.
+template <typename CalcT, int Columns = 16>
+class fractional {
+	static constexpr uint8_t	shr = 24;
+
+	tiled<CalcT, Columns>	m_integer;
+
+	int			m_radius;	// 'r + 1'
+	int			m_div;
+	int			m_mul_sum;	// 'w_r + w_r1'
+	int			m_mul_box;	// 'w_r'
+
+	// 'N' adjacent lines (columns of strip, or a row for 'N' == 1), stacks are interleaved as in 'tiled::do_strip()'.
+	template <int N>
+	void do_lines( uint32_t * __restrict p_col, int len, int advance ) const {
+		const int radius   = m_radius;
+		const int div      = m_div;
+		const int mul_sum  = m_mul_sum;
+		const int mul_box  = m_mul_box;
+		const CalcT round( _mm_set1_epi32( 1 << (shr - 1) ) );
+
+		uint32_t * p_stack = (uint32_t *)SAN_STACK_ALLOC( sizeof( uint32_t ) * N * div );
+
+		CalcT sum[N], sum_in[N], sum_out[N];
+
+		// Accum. left part of stacks (border color)...
+		{
+			int n = radius + 1;
+			for ( int c = 0; c < N; c++ ) {
+				uint32_t v = p_col[c];
+				for ( int i = 0; i <= radius; i++ ) p_stack[i * N + c] = v;
+				sum[c]     = CalcT( v ) * ((n * (n + 1)) >> 1);
+				sum_out[c] = CalcT( v ) * n;
+			}
+		}
+
+		// Accum. right part of stacks...
+		{
+			uint32_t * p_src = p_col;
+			uint32_t * p_stk = p_stack + (radius + 1) * N;
+			int j = radius;
+			for ( int i = 1; i <= radius; i++, j-- ) {
+				if ( SAN_LIKELY( i < len ) ) p_src += advance;
+				for ( int c = 0; c < N; c++ ) {
+					uint32_t v = p_src[c];
+					*p_stk++ = v;
+					sum[c]    += CalcT( v ) * j;
+					sum_in[c] += v;
+				}
+			}
+		}
+
+		// Lines not longer than radius have no pixels inside, all the rest reads the border pixel.
+		const int n_inner = std::max( len - (radius + 1), 0 );
+
+		int i_stack = radius;
+		uint32_t * p_src = p_col + advance * std::min( radius + 1, len - 1 );
+		uint32_t * p_dst = p_col;
+		int n = n_inner;
+
+		// Pixels inside line, then border pixel.
+		for ( int border = 0; border < 2; border++ ) {
+			if ( border ) {
+				p_src = p_col + advance * (len - 1);
+				n = len - n_inner;
+			}
+
+			while ( n-- > 0 ) {
+				int stack_start = i_stack + div - radius;
+				if ( stack_start >= div ) stack_start -= div;
+
+				if ( ++i_stack >= div ) i_stack = 0;
+
+				uint32_t * p_stk_start = p_stack + stack_start * N;
+				uint32_t * p_stk_next  = p_stack + i_stack * N;
+
+				for ( int c = 0; c < N; c++ ) {
+					CalcT box = sum_in[c];
+					box += sum_out[c];
+					CalcT r = sum[c] * mul_sum;
+					r -= box * mul_box;
+					r += round;
+					p_dst[c] = r >> shr;
+
+					sum[c] -= sum_out[c];
+
+					sum_out[c] -= p_stk_start[c];
+
+					uint32_t v = p_src[c];
+					p_stk_start[c] = v;
+					sum_in[c] += v;
+					sum[c]    += sum_in[c];
+
+					CalcT vn = p_stk_next[c];
+					sum_out[c] += vn;
+					sum_in[c]  -= vn;
+				}
+
+				if ( !border ) p_src += advance;
+				p_dst += advance;
+			}
+		}
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, float radius, int override_num_threads ) {
+		if ( !(radius > 0.f) ) return;
+		assert( image.bytes_per_pixel() == sizeof( uint32_t ) );
+
+		if ( radius >= float(CalcT::max_radius) ) {
+			m_integer( image, parallel_for, CalcT::max_radius, override_num_threads );
+			return;
+		}
+		if ( radius == float(int(radius)) ) {
+			m_integer( image, parallel_for, int(radius), override_num_threads );
+			return;
+		}
+
+		// Walk of 'r + 1' must fit in 'CalcT::max_radius'.
+		int r = std::min( int(radius), CalcT::max_radius - 1 );
+		double t = std::min( double(radius) - r, 1. );
+
+		// Multipliers of 'r + 1' and 'r' kernels, rounded down so their sum doesn't exceed '2^24'.
+		const double one = double(1 << shr);
+		int64_t d0 = int64_t(r + 1) * (r + 1);
+		int64_t d1 = int64_t(r + 2) * (r + 2);
+		int64_t w1 = int64_t(t * one / d1);
+		int64_t w0 = (int64_t(1) << shr) - w1 * d1;
+		w0 /= d0;
+
+		m_radius  = r + 1;
+		m_div     = m_radius * 2 + 1;
+		m_mul_sum = int(w0 + w1);
+		m_mul_box = int(w0);
+
+		// Horizontal pass...
+		parallel_for.run_and_wait( 0, image.height(), [&]( int a, int b ) {
+			for ( int y = a; y < b; y++ ) {
+				do_lines<1>( (uint32_t *)image.row_ptr( y ), image.width(), 1 );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (strips of columns, remaining columns one by one)...
+		int w = image.width();
+		int n_strips = w / Columns;
+		int advance = image.stride() / int(sizeof( uint32_t ));
+
+		parallel_for.run_and_wait( 0, n_strips + w % Columns, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				if ( i < n_strips ) {
+					do_lines<Columns>( (uint32_t *)image.col_ptr( i * Columns ), image.height(), advance );
+				} else {
+					do_lines<1>( (uint32_t *)image.col_ptr( n_strips * Columns + i - n_strips ), image.height(), advance );
+				}
+			}
+		}, override_num_threads );
+	}
+}; // class fractional
+
+} // namespace san::blur::stack::simd
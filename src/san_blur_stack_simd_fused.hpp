@@ -0,0 +1,83 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// 'tiled' with both passes fused into one fork/join.
+// Image is cut into horizontal bands of 'BandRows' rows. Workers first take bands and blur them horizontally,
+// then take strips of columns and run vertical stacks down, reading a row only when its band is done.
+// So vertical pass starts while horizontal one is still in progress and rows are consumed while they are hot in cache.
+// Bands are taken before strips and have no dependencies, so waiting for a band can't deadlock.
+template <typename CalcT, int Columns = 16, int BandRows = 16>
+class fused : public tiled <CalcT, Columns> {
+	static_assert( BandRows > 0 );
+
+	using base = tiled <CalcT, Columns>;
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( !base::set_radius( radius ) ) return;
+
+		int w = image.width();
+		int h = image.height();
+		int advance = image.stride() / image.components();
+
+		int n_bands  = (h + BandRows - 1) / BandRows;
+		int n_strips = w / Columns;
+		int n_lines  = n_strips + w % Columns;	// Strips, then remaining columns one by one
+
+		std::unique_ptr <std::atomic <bool>[]> band_done( new (std::nothrow) std::atomic <bool> [n_bands] );
+		if ( !band_done ) {
+			std::fprintf( stderr, "%s: couldn't allocate band flags.\n", __FUNCTION__ );
+			return;
+		}
+		for ( int i = 0; i < n_bands; i++ ) band_done[i] = false;
+
+		std::atomic <int> next_band = 0;
+		std::atomic <int> next_line = 0;
+
+		// Waits until band of row 'y' is blurred horizontally. Remembers number of ready rows of a strip.
+		struct rows_ready_t {
+			std::atomic <bool> *	p_done;
+			int						ready;
+
+			void operator () ( int y ) {
+				while ( y >= ready ) {
+					int spins = 0;
+					while ( !p_done[ready / BandRows].load( std::memory_order_acquire ) ) {
+						if ( ++spins < 1024 ) _mm_pause(); else std::this_thread::yield();
+					}
+					ready += BandRows;
+				}
+			}
+		};
+
+		// Every worker takes whatever is left: bands, then strips.
+		auto worker = [&]() {
+			for ( int i; (i = next_band.fetch_add( 1, std::memory_order_relaxed )) < n_bands; ) {
+				int y_end = std::min( h, (i + 1) * BandRows );
+				for ( int y = i * BandRows; y < y_end; y++ ) {
+					base::do_line( (uint32_t *)image.row_ptr( y ), w, 1 );
+				}
+				band_done[i].store( true, std::memory_order_release );
+			}
+
+			for ( int i; (i = next_line.fetch_add( 1, std::memory_order_relaxed )) < n_lines; ) {
+				rows_ready_t ready = { band_done.get(), 0 };
+				if ( i < n_strips ) {
+					base::template do_strip<Columns>( (uint32_t *)image.col_ptr( i * Columns ), h, advance, ready );
+				} else {
+					base::template do_strip<1>( (uint32_t *)image.col_ptr( n_strips * Columns + i - n_strips ), h, advance, ready );
+				}
+			}
+		};
+
+		// One item per thread, each of them runs the worker loop.
+		int n_threads = override_num_threads > 0 ? override_num_threads : parallel_for.num_threads();
+		parallel_for.run_and_wait( 0, n_threads, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) worker();
+		}, override_num_threads );
+	}
+}; // class fused
+
+} // namespace san::blur::stack::simd
@@ -0,0 +1,178 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Re-blur of changed region only (cursor, ticker text on mostly static frame). Result of horizontal pass is kept
+// in cached surface, so after change of 'dirty' rectangle of source only its rows are blurred horizontally (and only
+// where they change: 'dirty' dilated by radius), then only columns and rows of 'dirty' dilated by radius are blurred
+// vertically into 'dst'. Cost scales with dirty area instead of frame one. Result is the same as 'tiled' one.
+// Source and destination must be different images, 'dst' keeps output of previous calls outside of patched region.
+template <typename CalcT, int Columns = 16>
+class incremental : public tiled <CalcT, Columns> {
+	using base = optimized_2 <CalcT>;
+	using pixel_t = typename base::pixel_t;
+
+	std::unique_ptr <san::surface>	m_rows;		// Horizontal pass of whole source
+	int								m_cached_radius = 0;
+
+	// Stack blur of 'N' adjacent lines of 'len' pixels from 'p_src' to 'p_dst', only pixels '[beg, end)' are written,
+	// '[beg - radius, end + radius]' are read (line is extended by border pixels). Stacks are interleaved as in 'tiled'.
+	template <int N>
+	void do_window( const pixel_t * __restrict p_src, int src_advance, pixel_t * __restrict p_dst, int dst_advance,
+		int len, int beg, int end ) const
+	{
+		const int radius  = base::m_radius;
+		const int div     = base::m_div;
+		const int mul     = base::m_mul;
+		const uint8_t shr = base::m_shr;
+
+		auto src = [&]( int i ) { return p_src + std::clamp( i, 0, len - 1 ) * src_advance; };
+
+		pixel_t * p_stack = (pixel_t *)SAN_STACK_ALLOC( sizeof( pixel_t ) * N * div );
+
+		CalcT sum[N], sum_in[N], sum_out[N];
+
+		// Fill initial stacks...
+		for ( int i = -radius; i <= radius; i++ ) {
+			const pixel_t * p = src( beg + i );
+			pixel_t * p_stk = p_stack + (i + radius) * N;
+			int weight = radius + 1 - std::abs( i );
+			for ( int c = 0; c < N; c++ ) {
+				pixel_t v = p[c];
+				p_stk[c] = v;
+				sum[c] += CalcT( v ) * weight;
+				if ( i <= 0 ) {
+					sum_out[c] += v;
+				} else {
+					sum_in[c]  += v;
+				}
+			}
+		}
+
+		int i_stack = radius;
+		pixel_t * p_out = p_dst + beg * dst_advance;
+
+		for ( int i = beg; i < end; i++ ) {
+			const pixel_t * p_in = src( i + radius + 1 );
+
+			int stack_start = i_stack + div - radius;
+			if ( stack_start >= div ) stack_start -= div;
+
+			if ( ++i_stack >= div ) i_stack = 0;
+
+			pixel_t * p_stk_start = p_stack + stack_start * N;
+			pixel_t * p_stk_next  = p_stack + i_stack * N;
+
+			for ( int c = 0; c < N; c++ ) {
+				pixel_t r = sum[c] * mul >> shr;
+				p_out[c] = r;
+				sum[c] -= sum_out[c];
+
+				sum_out[c] -= p_stk_start[c];
+
+				pixel_t v = p_in[c];
+				p_stk_start[c] = v;
+				sum_in[c] += v;
+				sum[c]    += sum_in[c];
+
+				CalcT vn = p_stk_next[c];
+				sum_out[c] += vn;
+				sum_in[c]  -= vn;
+			}
+
+			p_out += dst_advance;
+		}
+	}
+
+	// Horizontal pass of 'rows' rows of 'x_range' from 'src' to cache, vertical one of 'cols' rect from cache to 'dst'.
+	template <typename ImageViewT, typename ParallelForT>
+	void do_rects( const ImageViewT & src, ImageViewT & dst, const roi::rect & rows, const roi::rect & cols,
+		ParallelForT & parallel_for, int override_num_threads )
+	{
+		const san::surface & cache = *m_rows;
+		const int w = src.width();
+		const int h = src.height();
+
+		// Horizontal pass...
+		parallel_for.run_and_wait( rows.y, rows.y + rows.h, [&]( int a, int b ) {
+			for ( int y = a; y < b; y++ ) {
+				do_window<1>( (const pixel_t *)src.row_ptr( y ), 1, (pixel_t *)cache.row_ptr( y ), 1, w, rows.x, rows.x + rows.w );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (strips of columns, remaining columns one by one)...
+		const int n_strips = cols.w / Columns;
+		const int cache_advance = cache.stride() / int(sizeof( pixel_t ));
+		const int dst_advance = dst.stride() / int(sizeof( pixel_t ));
+
+		parallel_for.run_and_wait( 0, n_strips + cols.w % Columns, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				if ( i < n_strips ) {
+					int x = cols.x + i * Columns;
+					do_window<Columns>( (const pixel_t *)cache.col_ptr( x ), cache_advance, (pixel_t *)dst.col_ptr( x ), dst_advance,
+						h, cols.y, cols.y + cols.h );
+				} else {
+					int x = cols.x + n_strips * Columns + i - n_strips;
+					do_window<1>( (const pixel_t *)cache.col_ptr( x ), cache_advance, (pixel_t *)dst.col_ptr( x ), dst_advance,
+						h, cols.y, cols.y + cols.h );
+				}
+			}
+		}, override_num_threads );
+	}
+
+public:
+	// Whole 'src' to 'dst' (same size and format), fills cache.
+	template <typename ImageViewT, typename ParallelForT>
+	void blur( const ImageViewT & src, ImageViewT & dst, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		assert( src.bytes_per_pixel() == sizeof( pixel_t ) );
+		assert( src.width() == dst.width() && src.height() == dst.height() && src.ptr() != dst.ptr() );
+
+		m_cached_radius = 0;
+		if ( !base::set_radius( radius ) ) {
+			src.blit_to( dst );
+			return;
+		}
+
+		if ( !m_rows || m_rows->width() != src.width() || m_rows->height() != src.height() || m_rows->format() != src.format() ) {
+			m_rows.reset( new (std::nothrow) san::surface( src.width(), src.height(), src.components(), src.format() ) );
+			if ( !m_rows || !*m_rows ) {
+				std::fprintf( stderr, "%s: couldn't allocate cache.\n", __FUNCTION__ );
+				m_rows.reset();
+				return;
+			}
+		}
+
+		const roi::rect all { 0, 0, src.width(), src.height() };
+		do_rects( src, dst, all, all, parallel_for, override_num_threads );
+		m_cached_radius = radius;
+	}
+
+	// Re-blur after change of 'dirty' rectangle of 'src'. 'dst' must have output of previous 'blur()' or 'update()'
+	// with the same 'src' image and radius, else whole image is blurred.
+	template <typename ImageViewT, typename ParallelForT>
+	void update( const ImageViewT & src, ImageViewT & dst, const roi::rect & dirty, ParallelForT & parallel_for,
+		int radius, int override_num_threads )
+	{
+		if ( !m_cached_radius || radius != m_cached_radius || m_rows->width() != src.width() || m_rows->height() != src.height() ||
+			m_rows->format() != src.format() )
+		{
+			blur( src, dst, parallel_for, radius, override_num_threads );
+			return;
+		}
+
+		const int w = src.width();
+		const int h = src.height();
+		const int r = base::m_radius;
+
+		roi::rect changed = dirty.clipped( w, h );
+		if ( changed.empty() ) return;
+
+		// Horizontal results change in dirty rows only, but up to radius to left and right of dirty pixels,
+		// vertical ones - in the same columns up to radius above and below.
+		const roi::rect rows = roi::rect{ changed.x - r, changed.y, changed.w + r * 2, changed.h }.clipped( w, h );
+		const roi::rect cols = changed.expanded( r ).clipped( w, h );
+		do_rects( src, dst, rows, cols, parallel_for, override_num_threads );
+	}
+}; // class incremental
+
+} // namespace san::blur::stack::simd
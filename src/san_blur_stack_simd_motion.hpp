@@ -0,0 +1,88 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Directional (motion) stack blur along an angle, one pass. Image is covered by parallel digital lines of the same
+// slope ('adaptor::sheared_line'): one pixel per step along the major axis and rounded offset along the minor one,
+// so every pixel belongs to exactly one line and stack update stays O(1) per pixel.
+// Radius is measured along direction, so it's shortened in steps of the major axis.
+// 'SIMDCalcT' - 'sse128_u32_t<2>', 'sse128_u32_t<41>'...
+template <typename SIMDCalcT>
+class motion {
+	float	m_angle;	// degrees, counter-clockwise from X axis, Y is down
+
+public:
+	motion( float angle = 0.f ) : m_angle( angle ) {}
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( radius < 1 ) return;
+		assert( image.bytes_per_pixel() == sizeof( uint32_t ) );
+
+		const double a = double(m_angle) * (3.14159265358979323846 / 180.);
+		const double dx = std::cos( a );
+		const double dy = -std::sin( a );
+
+		// Major axis is the one with bigger projection of direction...
+		const bool   x_major   = std::abs( dx ) >= std::abs( dy );
+		const int    n_major   = x_major ? image.width()  : image.height();
+		const int    n_minor   = x_major ? image.height() : image.width();
+		const double slope     = x_major ? dy / dx : dx / dy;
+		const ptrdiff_t stride = image.stride() / ptrdiff_t(sizeof( uint32_t ));
+		const ptrdiff_t adv_major = x_major ? 1 : stride;
+		const ptrdiff_t adv_minor = x_major ? stride : 1;
+
+		int steps = std::max( 1, int(std::lround( radius / std::sqrt( 1. + slope * slope ) )) );
+		steps = std::min( steps, SIMDCalcT::max_radius );
+
+		// Minor offsets of line pixels (monotonic) and offsets of pixels from line origin...
+		int *       p_minor = new (std::nothrow) int[n_major];
+		ptrdiff_t * p_offs  = new (std::nothrow) ptrdiff_t[n_major];
+		if ( !p_minor || !p_offs ) {
+			std::fprintf( stderr, "%s: couldn't allocate offsets\n", __FUNCTION__ );
+			delete [] p_minor;
+			delete [] p_offs;
+			return;
+		}
+
+		for ( int m = 0; m < n_major; m++ ) {
+			p_minor[m] = int(std::lround( m * slope ));
+			p_offs[m]  = m * adv_major + p_minor[m] * adv_minor;
+		}
+
+		const bool descending = p_minor[n_major - 1] < p_minor[0];
+		const int  d_min = std::min( p_minor[0], p_minor[n_major - 1] );
+		const int  d_max = std::max( p_minor[0], p_minor[n_major - 1] );
+
+		// First step of line 'k' with 'k + p_minor[m]' at least (at most for descending offsets) 'bound'.
+		auto first_step = [&]( int k, int bound ) {
+			int lo = 0, hi = n_major;
+			while ( lo < hi ) {
+				int mid = (lo + hi) >> 1;
+				bool before = descending ? k + p_minor[mid] > bound : k + p_minor[mid] < bound;
+				if ( before ) lo = mid + 1; else hi = mid;
+			}
+			return lo;
+		};
+
+		// Line 'k' starts at minor coord. 'k', its pixels inside image are a continuous range of steps...
+		const int k_beg = -d_max;
+		const int k_end = n_minor - d_min;
+
+		parallel_for.run_and_wait( k_beg, k_end, [&]( int ka, int kb ) {
+			for ( int k = ka; k < kb; k++ ) {
+				int m_beg = descending ? first_step( k, n_minor - 1 ) : first_step( k, 0 );
+				int m_end = descending ? first_step( k, -1 ) : first_step( k, n_minor );
+				if ( m_beg >= m_end ) continue;
+
+				adaptor::sheared_line line( (uint32_t *)image.ptr(), k * adv_minor, p_offs + m_beg, m_end - m_beg );
+				naive_do_line<SIMDCalcT>( line, 0, line.length(), steps );
+			}
+		}, override_num_threads );
+
+		delete [] p_minor;
+		delete [] p_offs;
+	}
+}; // class motion
+
+} // namespace san::blur::stack::simd
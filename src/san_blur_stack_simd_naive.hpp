@@ -2,8 +2,9 @@
 
 namespace san::blur::stack::simd {
 
-template <typename SIMDCalcT>
-void naive_do_line( adaptor::straight_line & line, int beg, int end/*exclusive*/, int radius ) {
+// 'LineT' - 32bpp line adaptor ('adaptor::straight_line', 'adaptor::sheared_line')
+template <typename SIMDCalcT, typename LineT = adaptor::straight_line>
+void naive_do_line( LineT & line, int beg, int end/*exclusive*/, int radius ) {
 	int div = radius * 2 + 1;
 	uint32_t * p_stack = (uint32_t *)SAN_STACK_ALLOC( sizeof( uint32_t ) * div );
 
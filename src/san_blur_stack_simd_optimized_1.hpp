@@ -82,7 +82,7 @@ public:
 	template <typename ImageViewT, typename ParallelForT>
 	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
 		if ( radius < 1 ) return;
-		if ( radius > 254 ) radius = 254;
+		if ( radius > CalcT::max_radius ) radius = CalcT::max_radius;
 
 		m_radius = radius;
 		m_div = radius * 2 + 1;
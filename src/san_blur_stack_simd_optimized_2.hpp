@@ -2,24 +2,36 @@
 
 namespace san::blur::stack::simd {
 
+// Transforms of pixels in 'do_line()': 'load' - of every pixel read from image, 'store' - of every result
+// (e.g. premultiplication of alpha, see 'premultiplied'). Default one keeps them as is.
+struct plain_io {
+	template <typename PixelT> static PixelT load ( PixelT c ) { return c; }
+	template <typename PixelT> static PixelT store( PixelT c ) { return c; }
+};
+
+// 'CalcT::pixel_type' - pixel type of image (see 'san_pixel.hpp').
 template <typename CalcT>
 class optimized_2 {
+protected:
+	using pixel_t = typename CalcT::pixel_type;
+
 	int			m_radius;
 	int			m_div;
-	uint16_t	m_mul;
+	uint32_t	m_mul;
 	uint8_t		m_shr;
 
 	//  p_line - points to begin of row or column
 	// advance - also '1' for rows or 'stride' for columns
-	void do_line( uint32_t * __restrict p_line, int len, int advance ) {
+	template <typename IoT = plain_io>
+	void do_line( pixel_t * __restrict p_line, int len, int advance ) {
 
-		uint32_t * p_stack = (uint32_t *)SAN_STACK_ALLOC( sizeof( uint32_t ) * m_div );
+		pixel_t * p_stack = (pixel_t *)SAN_STACK_ALLOC( sizeof( pixel_t ) * m_div );
 
 		// Accum. left part of stack (border color)...
-		uint32_t * p_stk = p_stack;
+		pixel_t * p_stk = p_stack;
 		CalcT sum, sum_out;
 		{
-			uint32_t c = *p_line;
+			pixel_t c = IoT::load( *p_line );
 			CalcT v( c );
 			for ( int i = 0; i <= m_radius; i++ ) *p_stk++ = c;
 			int n = m_radius + 1;
@@ -30,33 +42,30 @@ class optimized_2 {
 		// Accum. right part of stack...
 		CalcT sum_in;
 		{
-			uint32_t * p_src = p_line;
+			pixel_t * p_src = p_line;
 			int j = m_radius;
 			for ( int i = 1; i <= m_radius; i++, j-- ) {
 				if ( SAN_LIKELY( i < len ) ) p_src += advance;
-				uint32_t c = *p_src;
+				pixel_t c = IoT::load( *p_src );
 				*p_stk++ = c;
 				CalcT v( c );
 				sum    += v * j;
 				sum_in += v;
 			}
 
-			// At now, p_src == p_line + (m_radius * advance);
-			assert( p_src == p_line + (m_radius * advance) );
 		}
 
+		// Lines not longer than radius have no pixels inside, all the rest reads the border pixel.
+		int n_inner  = std::max( len - (m_radius + 1), 0 );
+		int n_border = len - n_inner;
 
 		int i_stack = m_radius;
-		uint32_t * p_src = p_line + advance * (m_radius + 1);
-		uint32_t * p_dst = p_line;
-
-		// TODO: handle that case
-		assert( len >= m_radius + 1 );
-		//int l = len - (m_radius + 1);
-		len -= m_radius + 1;
+		pixel_t * p_src = p_line + advance * std::min( m_radius + 1, len - 1 );
+		pixel_t * p_dst = p_line;
 
-		while ( len-- > 0 ) {
-			*p_dst = sum * int(m_mul) >> m_shr;	// Stupid MSC compiler with C2666
+		while ( n_inner-- > 0 ) {
+			pixel_t r = sum * int(m_mul) >> m_shr;	// Stupid MSC compiler with C2666
+			*p_dst = IoT::store( r );
 			sum -= sum_out;
 
 			int stack_start = i_stack + m_div - m_radius;
@@ -64,7 +73,7 @@ class optimized_2 {
 
 			sum_out -= p_stack[stack_start];
 
-			uint32_t c = *p_src;
+			pixel_t c = IoT::load( *p_src );
 			p_stack[stack_start] = c;
 			sum_in += c;
 			sum    += sum_in;
@@ -79,15 +88,12 @@ class optimized_2 {
 			p_dst += advance;
 		}
 
-		// At now, p_src == p_line + (len * advance);
-		//assert( p_src == p_line + (len * advance) );
-
-		p_src -= advance;
-		uint32_t border_c = *p_src;
+		pixel_t border_c = IoT::load( p_line[(len - 1) * advance] );
 		CalcT border_v( border_c );
 
-		for ( len = m_radius; len >= 0; len-- ) {
-			*p_dst = sum * int(m_mul) >> m_shr;
+		while ( n_border-- > 0 ) {
+			pixel_t r = sum * int(m_mul) >> m_shr;
+			*p_dst = IoT::store( r );
 			sum -= sum_out;
 
 			int stack_start = i_stack + m_div - m_radius;
@@ -110,30 +116,51 @@ class optimized_2 {
 		}
 	}
 
-public:
-	template <typename ImageViewT, typename ParallelForT>
-	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
-		if ( radius < 1 ) return;
-		if ( radius > 254 ) radius = 254;
+	// Returns false if there is nothing to do
+	bool set_radius( int radius ) {
+		if ( radius < 1 ) return false;
+		if ( radius > CalcT::max_radius ) radius = CalcT::max_radius;
 
 		m_radius = radius;
 		m_div = radius * 2 + 1;
-		m_mul = lut_mul[radius];
-		m_shr = lut_shr[radius];
+		if constexpr ( CalcT::lut_bits == 16 ) {
+			m_mul = lut16_mul[radius];
+			m_shr = lut16_shr[radius];
+		} else {
+			m_mul = lut_mul[radius];
+			m_shr = lut_shr[radius];
+		}
+		return true;
+	}
+
+public:
+	// Anisotropic blur, radius '0' skips the pass
+	template <typename ImageViewT, typename ParallelForT>
+	void blur_xy( ImageViewT & image, ParallelForT & parallel_for, int radius_x, int radius_y, int override_num_threads ) {
+		assert( image.bytes_per_pixel() == sizeof( pixel_t ) );
 
 		// Horizontal pass...
-		parallel_for.run_and_wait( 0, image.height(), [&]( int a, int b ) {
-			for ( int y = a; y < b; y++ ) {
-				do_line( (uint32_t *)image.row_ptr( y ), image.width(), 1 );
-			}
-		}, override_num_threads );
+		if ( set_radius( radius_x ) ) {
+			parallel_for.run_and_wait( 0, image.height(), [&]( int a, int b ) {
+				for ( int y = a; y < b; y++ ) {
+					do_line( (pixel_t *)image.row_ptr( y ), image.width(), 1 );
+				}
+			}, override_num_threads );
+		}
 
 		// Vertical pass...
-		parallel_for.run_and_wait( 0, image.width(), [&]( int a, int b ) {
-			for ( int x = a; x < b; x++ ) {
-				do_line( (uint32_t *)image.col_ptr( x ), image.height(), image.stride() / image.components() );
-			}
-		}, override_num_threads );
+		if ( set_radius( radius_y ) ) {
+			parallel_for.run_and_wait( 0, image.width(), [&]( int a, int b ) {
+				for ( int x = a; x < b; x++ ) {
+					do_line( (pixel_t *)image.col_ptr( x ), image.height(), image.stride() / int(sizeof( pixel_t )) );
+				}
+			}, override_num_threads );
+		}
+	}
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		blur_xy( image, parallel_for, radius, radius, override_num_threads );
 	}
 }; // class optimized_2
 
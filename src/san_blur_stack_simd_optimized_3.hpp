@@ -0,0 +1,166 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Same as 'optimized_2', but blurs two lines at once: two adjacent columns or two adjacent rows.
+// CalcT holds a pair of pixels packed in 'uint64_t' (see 'avx256_u32_t').
+template <typename CalcT>
+class optimized_3 {
+	int			m_radius;
+	int			m_div;
+	uint16_t	m_mul;
+	uint8_t		m_shr;
+
+	// Adjacent - pixels of the pair are neighbours in memory (two columns), so one 64-bit load/store is used.
+	// Otherwise pair is 'p[0]' and 'p[pair]' (two rows). 'pair' == 0 blurs single line.
+	template <bool Adjacent>
+	static uint64_t load( const uint32_t * p, int pair ) {
+		if constexpr ( Adjacent ) {
+			uint64_t v;
+			std::memcpy( &v, p, sizeof( v ) );
+			return v;
+		} else {
+			return uint64_t(p[pair]) << 32 | p[0];
+		}
+	}
+
+	template <bool Adjacent>
+	static void store( uint32_t * p, int pair, uint64_t v ) {
+		if constexpr ( Adjacent ) {
+			std::memcpy( p, &v, sizeof( v ) );
+		} else {
+			p[0]    = uint32_t(v);
+			p[pair] = uint32_t(v >> 32);
+		}
+	}
+
+	//  p_line - points to begin of first row or column of the pair
+	// advance - also '1' for rows or 'stride' for columns
+	template <bool Adjacent>
+	void do_line( uint32_t * __restrict p_line, int len, int advance, int pair ) {
+
+		uint64_t * p_stack = (uint64_t *)SAN_STACK_ALLOC( sizeof( uint64_t ) * m_div );
+
+		// Accum. left part of stack (border color)...
+		uint64_t * p_stk = p_stack;
+		CalcT sum, sum_out;
+		{
+			uint64_t c = load<Adjacent>( p_line, pair );
+			CalcT v( c );
+			for ( int i = 0; i <= m_radius; i++ ) *p_stk++ = c;
+			int n = m_radius + 1;
+			sum = v * ((n * (n + 1)) >> 1); // sum = 1v + 2v + 3v + ... + Nv, where N = m_radius + 1
+			sum_out = v * n;
+		}
+
+		// Accum. right part of stack...
+		CalcT sum_in;
+		{
+			uint32_t * p_src = p_line;
+			int j = m_radius;
+			for ( int i = 1; i <= m_radius; i++, j-- ) {
+				if ( SAN_LIKELY( i < len ) ) p_src += advance;
+				uint64_t c = load<Adjacent>( p_src, pair );
+				*p_stk++ = c;
+				CalcT v( c );
+				sum    += v * j;
+				sum_in += v;
+			}
+		}
+
+		// Lines not longer than radius have no pixels inside, all the rest reads the border pixel.
+		int n_inner  = std::max( len - (m_radius + 1), 0 );
+		int n_border = len - n_inner;
+
+		int i_stack = m_radius;
+		uint32_t * p_src = p_line + advance * std::min( m_radius + 1, len - 1 );
+		uint32_t * p_dst = p_line;
+
+		while ( n_inner-- > 0 ) {
+			store<Adjacent>( p_dst, pair, sum * int(m_mul) >> m_shr );
+			sum -= sum_out;
+
+			int stack_start = i_stack + m_div - m_radius;
+			if ( stack_start >= m_div ) stack_start -= m_div;
+
+			sum_out -= p_stack[stack_start];
+
+			uint64_t c = load<Adjacent>( p_src, pair );
+			p_stack[stack_start] = c;
+			sum_in += c;
+			sum    += sum_in;
+
+			if ( ++i_stack >= m_div ) i_stack = 0;
+
+			CalcT v = p_stack[i_stack];
+			sum_out += v;
+			sum_in  -= v;
+
+			p_src += advance;
+			p_dst += advance;
+		}
+
+		uint64_t border_c = load<Adjacent>( p_line + (len - 1) * advance, pair );
+		CalcT border_v( border_c );
+
+		while ( n_border-- > 0 ) {
+			store<Adjacent>( p_dst, pair, sum * int(m_mul) >> m_shr );
+			sum -= sum_out;
+
+			int stack_start = i_stack + m_div - m_radius;
+			if ( stack_start >= m_div ) stack_start -= m_div;
+
+			sum_out -= p_stack[stack_start];
+
+			p_stack[stack_start] = border_c;
+			sum_in += border_v;
+			sum    += sum_in;
+
+			if ( ++i_stack >= m_div ) i_stack = 0;
+
+			CalcT c = p_stack[i_stack];
+			sum_out += c;
+			sum_in  -= c;
+
+			p_dst += advance;
+		}
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( radius < 1 ) return;
+		if ( radius > CalcT::max_radius ) radius = CalcT::max_radius;
+
+		m_radius = radius;
+		m_div = radius * 2 + 1;
+		m_mul = lut_mul[radius];
+		m_shr = lut_shr[radius];
+
+		int w = image.width();
+		int h = image.height();
+		int stride = image.stride() / image.components();
+
+		// Horizontal pass (pairs of rows)...
+		parallel_for.run_and_wait( 0, (h + 1) / 2, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				int y = i * 2;
+				do_line<false>( (uint32_t *)image.row_ptr( y ), w, 1, y + 1 < h ? stride : 0 );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (pairs of columns)...
+		parallel_for.run_and_wait( 0, (w + 1) / 2, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				int x = i * 2;
+				if ( SAN_LIKELY( x + 1 < w ) ) {
+					do_line<true >( (uint32_t *)image.col_ptr( x ), h, stride, 1 );
+				} else {
+					do_line<false>( (uint32_t *)image.col_ptr( x ), h, stride, 0 );
+				}
+			}
+		}, override_num_threads );
+	}
+}; // class optimized_3
+
+} // namespace san::blur::stack::simd
@@ -0,0 +1,174 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Same as 'optimized_2', but blurs four lines at once: four adjacent columns or four adjacent rows.
+// CalcT holds four pixels packed in '__m128i' (see 'avx512_u32_t').
+// Must be dispatched only if CPU supports AVX-512F.
+template <typename CalcT>
+class optimized_4 {
+	int			m_radius;
+	int			m_div;
+	uint16_t	m_mul;
+	uint8_t		m_shr;
+
+	// Offsets of 2nd, 3rd and 4th lines from the 1st one. Equal offsets repeat the same line.
+	struct lanes_t {
+		int		o1, o2, o3;
+	};
+
+	// Adjacent - four columns are neighbours in memory, so one 128-bit load/store is used.
+	template <bool Adjacent>
+	SAN_TARGET_AVX512 static __m128i load( const uint32_t * p, const lanes_t & l ) {
+		if constexpr ( Adjacent ) {
+			return _mm_loadu_si128( (const __m128i *)p );
+		} else {
+			return _mm_setr_epi32( p[0], p[l.o1], p[l.o2], p[l.o3] );
+		}
+	}
+
+	template <bool Adjacent>
+	SAN_TARGET_AVX512 static void store( uint32_t * p, const lanes_t & l, const __m128i & v ) {
+		if constexpr ( Adjacent ) {
+			_mm_storeu_si128( (__m128i *)p, v );
+		} else {
+			p[l.o3] = _mm_extract_epi32( v, 3 );
+			p[l.o2] = _mm_extract_epi32( v, 2 );
+			p[l.o1] = _mm_extract_epi32( v, 1 );
+			p[0]    = _mm_cvtsi128_si32( v );
+		}
+	}
+
+	//  p_line - points to begin of first row or column of the four
+	// advance - also '1' for rows or 'stride' for columns
+	template <bool Adjacent>
+	SAN_TARGET_AVX512 void do_line( uint32_t * __restrict p_line, int len, int advance, const lanes_t & lanes ) {
+
+		__m128i * p_stack = (__m128i *)SAN_STACK_ALLOC( sizeof( __m128i ) * m_div );
+
+		// Accum. left part of stack (border color)...
+		__m128i * p_stk = p_stack;
+		CalcT sum, sum_out;
+		{
+			__m128i c = load<Adjacent>( p_line, lanes );
+			CalcT v( c );
+			for ( int i = 0; i <= m_radius; i++ ) *p_stk++ = c;
+			int n = m_radius + 1;
+			sum = v * ((n * (n + 1)) >> 1); // sum = 1v + 2v + 3v + ... + Nv, where N = m_radius + 1
+			sum_out = v * n;
+		}
+
+		// Accum. right part of stack...
+		CalcT sum_in;
+		{
+			uint32_t * p_src = p_line;
+			int j = m_radius;
+			for ( int i = 1; i <= m_radius; i++, j-- ) {
+				if ( SAN_LIKELY( i < len ) ) p_src += advance;
+				__m128i c = load<Adjacent>( p_src, lanes );
+				*p_stk++ = c;
+				CalcT v( c );
+				sum    += v * j;
+				sum_in += v;
+			}
+		}
+
+		// Lines not longer than radius have no pixels inside, all the rest reads the border pixel.
+		int n_inner  = std::max( len - (m_radius + 1), 0 );
+		int n_border = len - n_inner;
+
+		int i_stack = m_radius;
+		uint32_t * p_src = p_line + advance * std::min( m_radius + 1, len - 1 );
+		uint32_t * p_dst = p_line;
+
+		while ( n_inner-- > 0 ) {
+			store<Adjacent>( p_dst, lanes, sum * int(m_mul) >> m_shr );
+			sum -= sum_out;
+
+			int stack_start = i_stack + m_div - m_radius;
+			if ( stack_start >= m_div ) stack_start -= m_div;
+
+			sum_out -= p_stack[stack_start];
+
+			__m128i c = load<Adjacent>( p_src, lanes );
+			p_stack[stack_start] = c;
+			sum_in += c;
+			sum    += sum_in;
+
+			if ( ++i_stack >= m_div ) i_stack = 0;
+
+			CalcT v = p_stack[i_stack];
+			sum_out += v;
+			sum_in  -= v;
+
+			p_src += advance;
+			p_dst += advance;
+		}
+
+		__m128i border_c = load<Adjacent>( p_line + (len - 1) * advance, lanes );
+		CalcT border_v( border_c );
+
+		while ( n_border-- > 0 ) {
+			store<Adjacent>( p_dst, lanes, sum * int(m_mul) >> m_shr );
+			sum -= sum_out;
+
+			int stack_start = i_stack + m_div - m_radius;
+			if ( stack_start >= m_div ) stack_start -= m_div;
+
+			sum_out -= p_stack[stack_start];
+
+			p_stack[stack_start] = border_c;
+			sum_in += border_v;
+			sum    += sum_in;
+
+			if ( ++i_stack >= m_div ) i_stack = 0;
+
+			CalcT c = p_stack[i_stack];
+			sum_out += c;
+			sum_in  -= c;
+
+			p_dst += advance;
+		}
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( radius < 1 ) return;
+		if ( radius > CalcT::max_radius ) radius = CalcT::max_radius;
+
+		m_radius = radius;
+		m_div = radius * 2 + 1;
+		m_mul = lut_mul[radius];
+		m_shr = lut_shr[radius];
+
+		int w = image.width();
+		int h = image.height();
+		int stride = image.stride() / image.components();
+
+		// Horizontal pass (four rows at once)...
+		parallel_for.run_and_wait( 0, (h + 3) / 4, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				int y = i * 4;
+				int last = h - 1 - y;	// Repeat last row if there are less than four rows left
+				lanes_t lanes = { std::min( 1, last ) * stride, std::min( 2, last ) * stride, std::min( 3, last ) * stride };
+				do_line<false>( (uint32_t *)image.row_ptr( y ), w, 1, lanes );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (four columns at once)...
+		parallel_for.run_and_wait( 0, (w + 3) / 4, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				int x = i * 4;
+				int last = w - 1 - x;
+				if ( SAN_LIKELY( last >= 3 ) ) {
+					do_line<true >( (uint32_t *)image.col_ptr( x ), h, stride, { 1, 2, 3 } );
+				} else {
+					do_line<false>( (uint32_t *)image.col_ptr( x ), h, stride, { std::min( 1, last ), std::min( 2, last ), std::min( 3, last ) } );
+				}
+			}
+		}, override_num_threads );
+	}
+}; // class optimized_4
+
+} // namespace san::blur::stack::simd
@@ -0,0 +1,76 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Pixels are premultiplied when horizontal pass reads them...
+struct premultiply_on_load {
+	static uint32_t load ( uint32_t c ) { return pixel::premultiply( c ); }
+	static uint32_t store( uint32_t c ) { return c; }
+};
+
+// ...and unpremultiplied when vertical pass writes them.
+struct unpremultiply_on_store {
+	static uint32_t load ( uint32_t c ) { return c; }
+	static uint32_t store( uint32_t c ) { return pixel::unpremultiply( c ); }
+};
+
+// 'tiled' for 32bpp images with straight (not premultiplied) alpha in the high byte. Blur is done in premultiplied
+// space, so colors of transparent pixels don't bleed into opaque ones (dark fringes). Result is straight alpha too.
+// Fused - (un)premultiplication is done inside of passes, otherwise by separate passes over image (to compare with).
+// Images which are premultiplied already (e.g. 'BL_FORMAT_PRGB32' of blend2d) need plain blur.
+template <typename CalcT, int Columns = 16, bool Fused = true>
+class premultiplied : public tiled <CalcT, Columns> {
+	using base = tiled <CalcT, Columns>;
+
+	static_assert( std::is_same_v<typename CalcT::pixel_type, uint32_t> );
+
+	template <typename ImageViewT, typename ParallelForT, typename F>
+	static void for_each_pixel( ImageViewT & image, ParallelForT & parallel_for, int override_num_threads, F && f ) {
+		parallel_for.run_and_wait( 0, image.height(), [&]( int a, int b ) {
+			for ( int y = a; y < b; y++ ) {
+				uint32_t * p = (uint32_t *)image.row_ptr( y );
+				for ( int x = 0; x < image.width(); x++ ) p[x] = f( p[x] );
+			}
+		}, override_num_threads );
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		assert( image.bytes_per_pixel() == sizeof( uint32_t ) );
+
+		if constexpr ( !Fused ) {
+			if ( radius < 1 ) return;
+			for_each_pixel( image, parallel_for, override_num_threads, pixel::premultiply );
+			base::operator () ( image, parallel_for, radius, override_num_threads );
+			for_each_pixel( image, parallel_for, override_num_threads, pixel::unpremultiply );
+			return;
+		}
+
+		if ( !base::set_radius( radius ) ) return;
+
+		// Horizontal pass...
+		parallel_for.run_and_wait( 0, image.height(), [&]( int a, int b ) {
+			for ( int y = a; y < b; y++ ) {
+				base::template do_line<premultiply_on_load>( (uint32_t *)image.row_ptr( y ), image.width(), 1 );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (strips of columns, remaining columns one by one)...
+		int w = image.width();
+		int n_strips = w / Columns;
+		int advance = image.stride() / int(sizeof( uint32_t ));
+
+		parallel_for.run_and_wait( 0, n_strips + w % Columns, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				if ( i < n_strips ) {
+					base::template do_strip<Columns, unpremultiply_on_store>( (uint32_t *)image.col_ptr( i * Columns ), image.height(), advance );
+				} else {
+					base::template do_strip<1, unpremultiply_on_store>( (uint32_t *)image.col_ptr( n_strips * Columns + i - n_strips ), image.height(), advance );
+				}
+			}
+		}, override_num_threads );
+	}
+}; // class premultiplied
+
+} // namespace san::blur::stack::simd
@@ -0,0 +1,167 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Stack blur for small radii (UI softening) with 16-bit sums, 'CalcT::pixels' lines at once:
+// two per SSE register ('sse128_u16_t') or four per AVX2 register ('avx256_u16_t').
+// Same result as 'optimized_2' with 'sse128_u32_t'. Radii above 'CalcT::max_radius' are passed to 'FallbackT'.
+template <typename CalcT, typename FallbackT>
+class small_radius {
+	using packed_t = typename CalcT::packed_type;
+	static constexpr int N = CalcT::pixels;
+
+	static_assert( sizeof( packed_t ) == sizeof( uint32_t ) * N );
+	static_assert( lut_shr[CalcT::max_radius] <= 16 );
+
+	FallbackT	m_fallback;
+	int			m_radius;
+	int			m_div;
+	uint16_t	m_mul;	// 'lut_mul[radius] << (16 - lut_shr[radius])'
+
+	// Pixel of line 'k' is 'p[offs[k]]'. Adjacent - lines are neighbour columns, so one load/store is used.
+	// Lines may repeat (last group of image), then the same pixel is stored twice.
+	template <bool Adjacent>
+	static packed_t load( const uint32_t * p, const int (&offs)[N] ) {
+		packed_t v;
+		if constexpr ( Adjacent ) {
+			std::memcpy( &v, p, sizeof( v ) );
+		} else {
+			uint32_t c[N];
+			for ( int k = 0; k < N; k++ ) c[k] = p[offs[k]];
+			std::memcpy( &v, c, sizeof( v ) );
+		}
+		return v;
+	}
+
+	template <bool Adjacent>
+	static void store( uint32_t * p, const int (&offs)[N], const packed_t & v ) {
+		if constexpr ( Adjacent ) {
+			std::memcpy( p, &v, sizeof( v ) );
+		} else {
+			uint32_t c[N];
+			std::memcpy( c, &v, sizeof( v ) );
+			for ( int k = 0; k < N; k++ ) p[offs[k]] = c[k];
+		}
+	}
+
+	//  p_line - points to begin of the first line of group
+	// advance - '1' for rows or 'stride' for columns
+	template <bool Adjacent>
+	void do_line( uint32_t * __restrict p_line, int len, int advance, const int (&offs)[N] ) {
+		const int radius = m_radius;
+		const int div    = m_div;
+
+		packed_t * p_stack = (packed_t *)SAN_STACK_ALLOC( sizeof( packed_t ) * div );
+
+		// Accum. left part of stack (border color)...
+		CalcT sum, sum_in, sum_out;
+		{
+			packed_t c = load<Adjacent>( p_line, offs );
+			CalcT v( c );
+			for ( int i = 0; i <= radius; i++ ) p_stack[i] = c;
+			int n = radius + 1;
+			sum     = v * ((n * (n + 1)) >> 1);
+			sum_out = v * n;
+		}
+
+		// Accum. right part of stack...
+		{
+			uint32_t * p_src = p_line;
+			int j = radius;
+			for ( int i = 1; i <= radius; i++, j-- ) {
+				if ( SAN_LIKELY( i < len ) ) p_src += advance;
+				packed_t c = load<Adjacent>( p_src, offs );
+				p_stack[radius + i] = c;
+				CalcT v( c );
+				sum    += v * j;
+				sum_in += v;
+			}
+		}
+
+		// Lines not longer than radius have no pixels inside, all the rest reads the border pixel.
+		const int n_inner = std::max( len - (radius + 1), 0 );
+
+		int i_stack = radius;
+		uint32_t * p_src = p_line + advance * std::min( radius + 1, len - 1 );
+		uint32_t * p_dst = p_line;
+		int n = n_inner;
+
+		// Pixels inside line, then border pixel.
+		for ( int border = 0; border < 2; border++ ) {
+			if ( border ) {
+				p_src = p_line + advance * (len - 1);
+				n = len - n_inner;
+			}
+
+			while ( n-- > 0 ) {
+				store<Adjacent>( p_dst, offs, sum.mulhi( m_mul ) );
+				sum -= sum_out;
+
+				int stack_start = i_stack + div - radius;
+				if ( stack_start >= div ) stack_start -= div;
+
+				sum_out -= p_stack[stack_start];
+
+				packed_t c = load<Adjacent>( p_src, offs );
+				p_stack[stack_start] = c;
+				sum_in += c;
+				sum    += sum_in;
+
+				if ( ++i_stack >= div ) i_stack = 0;
+
+				CalcT v = p_stack[i_stack];
+				sum_out += v;
+				sum_in  -= v;
+
+				if ( !border ) p_src += advance;
+				p_dst += advance;
+			}
+		}
+	}
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( radius > CalcT::max_radius ) {
+			m_fallback( image, parallel_for, radius, override_num_threads );
+			return;
+		}
+
+		if ( radius < 1 ) return;
+		assert( image.bytes_per_pixel() == sizeof( uint32_t ) );
+
+		m_radius = radius;
+		m_div    = radius * 2 + 1;
+		m_mul    = uint16_t(lut_mul[radius] << (16 - lut_shr[radius]));
+
+		int w = image.width();
+		int h = image.height();
+		int stride = image.stride() / int(sizeof( uint32_t ));
+
+		// Horizontal pass (groups of 'N' rows)...
+		parallel_for.run_and_wait( 0, (h + N - 1) / N, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				int y = i * N;
+				int offs[N];
+				for ( int k = 0; k < N; k++ ) offs[k] = std::min( k, h - 1 - y ) * stride;
+				do_line<false>( (uint32_t *)image.row_ptr( y ), w, 1, offs );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (groups of 'N' adjacent columns)...
+		parallel_for.run_and_wait( 0, (w + N - 1) / N, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				int x = i * N;
+				int offs[N];
+				for ( int k = 0; k < N; k++ ) offs[k] = std::min( k, w - 1 - x );
+				if ( SAN_LIKELY( x + N <= w ) ) {
+					do_line<true >( (uint32_t *)image.col_ptr( x ), h, stride, offs );
+				} else {
+					do_line<false>( (uint32_t *)image.col_ptr( x ), h, stride, offs );
+				}
+			}
+		}, override_num_threads );
+	}
+}; // class small_radius
+
+} // namespace san::blur::stack::simd
@@ -0,0 +1,173 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// Streaming (row by row) version of 'optimized_2' for images which don't fit in memory.
+// Rows are pushed in from top to bottom, blurred rows come out with delay of 'radius' rows:
+// output row 'y' is written by push of row 'y + radius' (the last 'radius' rows - by 'flush()').
+// Resident state is vertical stacks of all columns ('2 * radius + 1' rows) plus one row, i.e. width x radius.
+//
+//	stream <sse128_u32_t<41>> s( width, radius );
+//	for ( y = 0; y < height; y++ ) if ( s.push( src_row( y ), dst_row( n_out ) ) ) n_out++;
+//	while ( s.flush( dst_row( n_out ) ) ) n_out++;
+//
+// Output is the same as of 'optimized_2' (or 'tiled') run on a whole image.
+template <typename CalcT>
+class stream : public optimized_2 <CalcT> {
+	using base = optimized_2 <CalcT>;
+
+	int							m_width;
+	int							m_rows_in	= 0;
+	int							m_rows_out	= 0;
+	int							m_i_stack;
+	std::unique_ptr <uint32_t[]>	m_line;		// Current row, blurred horizontally
+	std::unique_ptr <uint32_t[]>	m_stacks;	// Vertical stacks, interleaved: entry 'i' of all stacks is row 'i'
+	std::unique_ptr <CalcT[]>		m_sum;
+	std::unique_ptr <CalcT[]>		m_sum_in;
+	std::unique_ptr <CalcT[]>		m_sum_out;
+
+	uint32_t * stack_row( int i ) { return m_stacks.get() + size_t(i) * m_width; }
+
+	// Puts 'p_src' as row 'i' (<= radius) into stacks accumulated from the previous rows.
+	void accum( const uint32_t * p_src, int i_row ) {
+		const int radius = base::m_radius;
+
+		if ( !i_row ) {
+			int n = radius + 1;
+			for ( int x = 0; x < m_width; x++ ) {
+				uint32_t v = p_src[x];
+				for ( int i = 0; i <= radius; i++ ) stack_row( i )[x] = v;
+				m_sum[x]     = CalcT( v ) * ((n * (n + 1)) >> 1);
+				m_sum_out[x] = CalcT( v ) * n;
+				m_sum_in[x]  = CalcT();
+			}
+		} else {
+			int j = radius + 1 - i_row;
+			uint32_t * p_stk = stack_row( radius + i_row );
+			for ( int x = 0; x < m_width; x++ ) {
+				uint32_t v = p_src[x];
+				p_stk[x] = v;
+				m_sum[x]    += CalcT( v ) * j;
+				m_sum_in[x] += v;
+			}
+		}
+	}
+
+	// Writes the first blurred row to 'p_dst', stacks are accumulated up to row 'radius'.
+	void write_first( uint32_t * p_dst ) {
+		const int mul     = base::m_mul;
+		const uint8_t shr = base::m_shr;
+
+		for ( int x = 0; x < m_width; x++ ) p_dst[x] = m_sum[x] * mul >> shr;
+		m_rows_out++;
+	}
+
+	// Moves stacks down by 'p_src' row and writes next blurred row to 'p_dst'.
+	void step( const uint32_t * p_src, uint32_t * p_dst ) {
+		const int radius  = base::m_radius;
+		const int div     = base::m_div;
+		const int mul     = base::m_mul;
+		const uint8_t shr = base::m_shr;
+
+		int stack_start = m_i_stack + div - radius;
+		if ( stack_start >= div ) stack_start -= div;
+
+		if ( ++m_i_stack >= div ) m_i_stack = 0;
+
+		uint32_t * p_stk_start = stack_row( stack_start );
+		uint32_t * p_stk_next  = stack_row( m_i_stack );
+
+		for ( int x = 0; x < m_width; x++ ) {
+			m_sum[x] -= m_sum_out[x];
+
+			m_sum_out[x] -= p_stk_start[x];
+
+			uint32_t v = p_src[x];
+			p_stk_start[x] = v;
+			m_sum_in[x] += v;
+			m_sum[x]    += m_sum_in[x];
+
+			CalcT vn = p_stk_next[x];
+			m_sum_out[x] += vn;
+			m_sum_in[x]  -= vn;
+
+			p_dst[x] = m_sum[x] * mul >> shr;
+		}
+		m_rows_out++;
+	}
+
+public:
+	stream( int width, int radius ) : m_width( width ) {
+		if ( !base::set_radius( radius ) || width < 1 ) return;
+
+		m_i_stack = base::m_radius;
+		m_line    .reset( new (std::nothrow) uint32_t [width] );
+		m_stacks  .reset( new (std::nothrow) uint32_t [size_t(width) * base::m_div] );
+		m_sum     .reset( new (std::nothrow) CalcT [width] );
+		m_sum_in  .reset( new (std::nothrow) CalcT [width] );
+		m_sum_out .reset( new (std::nothrow) CalcT [width] );
+		if ( !valid() ) {
+			std::fprintf( stderr, "%s: couldn't allocate stream state.\n", __FUNCTION__ );
+		}
+	}
+
+	// False if radius or width is bad or there is not enough memory.
+	bool valid() const { return m_line && m_stacks && m_sum && m_sum_in && m_sum_out; }
+
+	int rows_in()  const { return m_rows_in; }
+	int rows_out() const { return m_rows_out; }
+
+	// Pushes next source row. Returns 'true' if next blurred row (number 'rows_out() - 1') was written to 'p_dst'.
+	// 'p_dst' may point to the same row as 'p_src' or to any row already pushed.
+	bool push( const uint32_t * p_src, uint32_t * p_dst ) {
+		if ( !valid() ) return false;
+
+		std::memcpy( m_line.get(), p_src, sizeof( uint32_t ) * m_width );
+		base::do_line( m_line.get(), m_width, 1 );
+
+		bool out = m_rows_in >= base::m_radius;
+		if ( m_rows_in > base::m_radius ) {
+			step( m_line.get(), p_dst );
+		} else {
+			accum( m_line.get(), m_rows_in );
+			if ( out ) write_first( p_dst );
+		}
+		m_rows_in++;
+		return out;
+	}
+
+	// Call after the last row was pushed. Writes next of the remaining 'radius' rows
+	// (all rows of image not taller than that) to 'p_dst'.
+	// Returns 'false' when all rows are out.
+	bool flush( uint32_t * p_dst ) {
+		if ( !valid() || m_rows_out >= m_rows_in ) return false;
+
+		// Image is not taller than radius: rest of stacks is filled with the last row.
+		if ( !m_rows_out ) {
+			for ( int i = m_rows_in; i <= base::m_radius; i++ ) accum( m_line.get(), i );
+			write_first( p_dst );
+		} else {
+			step( m_line.get(), p_dst );
+		}
+		return true;
+	}
+}; // class stream
+
+// Runs 'stream' over whole image in place. To check and benchmark it along with other implementations.
+template <typename CalcT>
+class streamed {
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT &, int radius, int ) {
+		stream <CalcT> s( image.width(), radius );
+		if ( !s.valid() ) return;
+
+		int y_out = 0;
+		for ( int y = 0; y < image.height(); y++ ) {
+			if ( s.push( (const uint32_t *)image.row_ptr( y ), (uint32_t *)image.row_ptr( y_out ) ) ) y_out++;
+		}
+		while ( s.flush( (uint32_t *)image.row_ptr( y_out ) ) ) y_out++;
+	}
+}; // class streamed
+
+} // namespace san::blur::stack::simd
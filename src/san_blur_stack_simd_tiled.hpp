@@ -0,0 +1,157 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// 'optimized_2' with cache-blocked vertical pass.
+// Vertical pass walks a strip of 'Columns' adjacent columns row by row instead of one column at a time,
+// so every loaded cache line is fully used (16 columns of 32bpp pixels is 64 bytes, of 64bpp - two lines).
+// Stacks of all columns of the strip are interleaved (SoA): entry 'i' of every stack lies in one 'Columns' wide row.
+template <typename CalcT, int Columns = 16>
+class tiled : public optimized_2 <CalcT> {
+	static_assert( Columns > 0 );
+
+	using base = optimized_2 <CalcT>;
+	using pixel_t = typename base::pixel_t;
+
+protected:
+	// No-op for 'do_strip()' when whole image is ready
+	struct rows_ready_t {
+		void operator () ( int ) const {}
+	};
+
+	//   p_col - points to top of the first column of the strip
+	// advance - stride in pixels
+	//   ready - called with row index before that row is read first time (rows come in ascending order)
+	//     IoT - transforms of loaded and stored pixels (see 'plain_io')
+	template <int N, typename IoT = plain_io, typename ReadyF = rows_ready_t>
+	void do_strip( pixel_t * __restrict p_col, int len, int advance, ReadyF && ready = ReadyF() ) {
+		const int radius  = base::m_radius;
+		const int div     = base::m_div;
+		const int mul     = base::m_mul;
+		const uint8_t shr = base::m_shr;
+
+		pixel_t * p_stack = (pixel_t *)SAN_STACK_ALLOC( sizeof( pixel_t ) * N * div );
+
+		CalcT sum[N], sum_in[N], sum_out[N];
+
+		// Accum. left part of stacks (border color)...
+		{
+			int n = radius + 1;
+			ready( 0 );
+			for ( int c = 0; c < N; c++ ) {
+				pixel_t v = IoT::load( p_col[c] );
+				for ( int i = 0; i <= radius; i++ ) p_stack[i * N + c] = v;
+				sum[c]     = CalcT( v ) * ((n * (n + 1)) >> 1);
+				sum_out[c] = CalcT( v ) * n;
+			}
+		}
+
+		// Accum. right part of stacks...
+		{
+			pixel_t * p_src = p_col;
+			pixel_t * p_stk = p_stack + (radius + 1) * N;
+			int j = radius;
+			for ( int i = 1; i <= radius; i++, j-- ) {
+				if ( SAN_LIKELY( i < len ) ) {
+					p_src += advance;
+					ready( i );
+				}
+				for ( int c = 0; c < N; c++ ) {
+					pixel_t v = IoT::load( p_src[c] );
+					*p_stk++ = v;
+					sum[c]    += CalcT( v ) * j;
+					sum_in[c] += v;
+				}
+			}
+		}
+
+		// Strips not longer than radius have no rows inside, all the rest reads the bottom border row.
+		const int n_inner = std::max( len - (radius + 1), 0 );
+
+		int i_stack = radius;
+		int y_src = radius + 1;
+		pixel_t * p_src = p_col + advance * std::min( y_src, len - 1 );
+		pixel_t * p_dst = p_col;
+		int n = n_inner;
+
+		// Rows with source pixels inside image, then rows with bottom border pixel.
+		for ( int border = 0; border < 2; border++ ) {
+			if ( border ) {
+				p_src = p_col + advance * (len - 1);
+				n = len - n_inner;
+			}
+
+			while ( n-- > 0 ) {
+				if ( !border ) ready( y_src++ );
+
+				int stack_start = i_stack + div - radius;
+				if ( stack_start >= div ) stack_start -= div;
+
+				if ( ++i_stack >= div ) i_stack = 0;
+
+				pixel_t * p_stk_start = p_stack + stack_start * N;
+				pixel_t * p_stk_next  = p_stack + i_stack * N;
+
+				for ( int c = 0; c < N; c++ ) {
+					pixel_t r = sum[c] * mul >> shr;
+					p_dst[c] = IoT::store( r );
+					sum[c] -= sum_out[c];
+
+					sum_out[c] -= p_stk_start[c];
+
+					pixel_t v = IoT::load( p_src[c] );
+					p_stk_start[c] = v;
+					sum_in[c] += v;
+					sum[c]    += sum_in[c];
+
+					CalcT vn = p_stk_next[c];
+					sum_out[c] += vn;
+					sum_in[c]  -= vn;
+				}
+
+				if ( !border ) p_src += advance;
+				p_dst += advance;
+			}
+		}
+	}
+
+public:
+	// Anisotropic blur, radius '0' skips the pass
+	template <typename ImageViewT, typename ParallelForT>
+	void blur_xy( ImageViewT & image, ParallelForT & parallel_for, int radius_x, int radius_y, int override_num_threads ) {
+		assert( image.bytes_per_pixel() == sizeof( pixel_t ) );
+
+		// Horizontal pass...
+		if ( base::set_radius( radius_x ) ) {
+			parallel_for.run_and_wait( 0, image.height(), [&]( int a, int b ) {
+				for ( int y = a; y < b; y++ ) {
+					base::do_line( (pixel_t *)image.row_ptr( y ), image.width(), 1 );
+				}
+			}, override_num_threads );
+		}
+
+		if ( !base::set_radius( radius_y ) ) return;
+
+		// Vertical pass (strips of columns, remaining columns one by one)...
+		int w = image.width();
+		int n_strips = w / Columns;
+		int advance = image.stride() / int(sizeof( pixel_t ));
+
+		parallel_for.run_and_wait( 0, n_strips + w % Columns, [&]( int a, int b ) {
+			for ( int i = a; i < b; i++ ) {
+				if ( i < n_strips ) {
+					do_strip<Columns>( (pixel_t *)image.col_ptr( i * Columns ), image.height(), advance );
+				} else {
+					do_strip<1>( (pixel_t *)image.col_ptr( n_strips * Columns + i - n_strips ), image.height(), advance );
+				}
+			}
+		}, override_num_threads );
+	}
+
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		blur_xy( image, parallel_for, radius, radius, override_num_threads );
+	}
+}; // class tiled
+
+} // namespace san::blur::stack::simd
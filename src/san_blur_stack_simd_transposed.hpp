@@ -0,0 +1,55 @@
+#pragma once
+
+namespace san::blur::stack::simd {
+
+// 'optimized_2' where vertical pass is done by the same horizontal kernel.
+// A strip of 'Columns' adjacent columns is transposed (4x4 SIMD blocks) into rows of a per-thread scratch buffer,
+// blurred there as contiguous rows and transposed back, so every pass is a contiguous row scan.
+template <typename CalcT, int Columns = 16>
+class transposed : public optimized_2 <CalcT> {
+	static_assert( Columns > 0 && Columns % 4 == 0 );
+
+	using base = optimized_2 <CalcT>;
+
+public:
+	template <typename ImageViewT, typename ParallelForT>
+	void operator () ( ImageViewT & image, ParallelForT & parallel_for, int radius, int override_num_threads ) {
+		if ( !base::set_radius( radius ) ) return;
+
+		int w = image.width();
+		int h = image.height();
+
+		// Horizontal pass...
+		parallel_for.run_and_wait( 0, h, [&]( int a, int b ) {
+			for ( int y = a; y < b; y++ ) {
+				base::do_line( (uint32_t *)image.row_ptr( y ), w, 1 );
+			}
+		}, override_num_threads );
+
+		// Vertical pass (transposed strips)...
+		int advance = image.stride() / image.components();
+		int scratch_stride = (h + 15) & ~15;	// Rows padded to 64 bytes
+
+		parallel_for.run_and_wait( 0, (w + Columns - 1) / Columns, [&]( int a, int b ) {
+			std::unique_ptr <uint32_t[]> scratch( new (std::nothrow) uint32_t [scratch_stride * Columns] );
+			if ( !scratch ) {
+				std::fprintf( stderr, "%s: couldn't allocate scratch buffer.\n", __FUNCTION__ );
+				return;
+			}
+
+			for ( int i = a; i < b; i++ ) {
+				int x = i * Columns;
+				int cols = std::min( Columns, w - x );
+				uint32_t * p_col = (uint32_t *)image.col_ptr( x );
+
+				transpose( p_col, advance, scratch.get(), scratch_stride, cols, h );
+				for ( int c = 0; c < cols; c++ ) {
+					base::do_line( scratch.get() + c * scratch_stride, h, 1 );
+				}
+				transpose( scratch.get(), scratch_stride, p_col, advance, h, cols );
+			}
+		}, override_num_threads );
+	}
+}; // class transposed
+
+} // namespace san::blur::stack::simd
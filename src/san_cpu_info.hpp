@@ -7,16 +7,18 @@ class cpu_info {
 	using i32x4 = int32_t [4];
 
 	int				m_funcs_num;
-	i32x4			m_funcs[8];			// I don't need higher functions...
+	i32x4			m_funcs[8] = {};	// I don't need higher functions...
 
 	int				m_funcs_ext_num;
-	i32x4			m_funcs_ext[5];		// ...
+	i32x4			m_funcs_ext[5] = {};// ...
+
+	uint64_t		m_xcr0 = 0;			// Register states enabled by OS (zero without OSXSAVE)
 
 	std::string		m_vendor;
 	std::string		m_brand;
 	std::string		m_feats;
 
-	enum class feat_e : uint8_t { /*SSE,*/ SSE2, SSE3, SSSE3, SSE41/*, SSE42*/, FMA3, AVX, AVX2/*, BMI1, BMI2*/, FEAT_E_MAX };
+	enum class feat_e : uint8_t { /*SSE,*/ SSE2, SSE3, SSSE3, SSE41/*, SSE42*/, FMA3, AVX, F16C, AVX2/*, BMI1, BMI2*/, AVX512F, AVX512BW, FEAT_E_MAX };
 	enum class  reg_e : uint8_t { eax, ebx, ecx, edx };
 
 #define DEF_FEATURE( feat, fun, reg, bit ) { feat_e::feat, fun, reg, bit, #feat }
@@ -38,24 +40,49 @@ class cpu_info {
 		//DEF_FEATURE( SSE42, 1, reg_e::ecx, 20 ),
 		DEF_FEATURE(  FMA3, 1, reg_e::ecx, 12 ),
 		DEF_FEATURE(   AVX, 1, reg_e::ecx, 28 ),
+		DEF_FEATURE(  F16C, 1, reg_e::ecx, 29 ),
 
 		DEF_FEATURE(  AVX2, 7, reg_e::ebx,  5 ),
 		//DEF_FEATURE(  BMI1, 7, reg_e::ebx,  3 ),
-		//DEF_FEATURE(  BMI2, 7, reg_e::ebx,  8 )
+		//DEF_FEATURE(  BMI2, 7, reg_e::ebx,  8 ),
+		DEF_FEATURE(  AVX512F, 7, reg_e::ebx, 16 ),
+		DEF_FEATURE( AVX512BW, 7, reg_e::ebx, 30 )
 	};
 
 #undef DEF_FEATURE
 
+	// MSVC-style '__cpuidex' for all supported toolchains
+	static void cpuid( i32x4 & data, int fun, int sub_fun = 0 ) {
+#if defined( _WIN32 )
+		__cpuidex( data, fun, sub_fun );
+#else
+		unsigned a, b, c, d;
+		__cpuid_count( fun, sub_fun, a, b, c, d );
+		data[0] = a; data[1] = b; data[2] = c; data[3] = d;
+#endif
+	}
+
+	// MSVC-style '_xgetbv', GCC and Clang have it only with '-mxsave'
+	static uint64_t xgetbv( unsigned index ) {
+#if defined( _WIN32 )
+		return _xgetbv( index );
+#else
+		unsigned a, d;
+		__asm__ volatile ( "xgetbv" : "=a"( a ), "=d"( d ) : "c"( index ) );
+		return uint64_t(d) << 32 | a;
+#endif
+	}
+
 public:
 	cpu_info() {
 
 		// EAX=0: Highest Function Parameter and Manufacturer ID
 		i32x4 data;
-		__cpuid( data, 0 );
+		cpuid( data, 0 );
 		m_funcs_num = data[0] + 1;
 		if ( m_funcs_num > 8 ) m_funcs_num = 8;	// Don't need more...
 		for ( int i = 0; i < m_funcs_num; ++i ) {
-			__cpuidex( m_funcs[i], i, 0 );
+			cpuid( m_funcs[i], i );
 		}
 
 		// Get vendor string
@@ -63,11 +90,11 @@ public:
 		m_vendor = std::string( reinterpret_cast<const char *>( &m_funcs[0][1] ), 12 );
 
 		// EAX=80000000h: Get Highest Extended Function Implemented
-		__cpuid( data, 0x80000000 );
+		cpuid( data, 0x80000000 );
 		m_funcs_ext_num = data[0] - 0x80000000 + 1;
 		if ( m_funcs_ext_num > 5 ) m_funcs_ext_num = 5;	// Don't need more...
 		for ( int i = 0; i < m_funcs_ext_num; ++i ) {
-			__cpuidex( m_funcs_ext[i], i + 0x80000000, 0 );
+			cpuid( m_funcs_ext[i], i + 0x80000000 );
 		}
 
 		// Get brand string
@@ -78,6 +105,11 @@ public:
 			m_brand = std::string( p_brand, p - p_brand + 1 );
 		}
 
+		// OSXSAVE: 'xgetbv' is available
+		if ( m_funcs[1][static_cast<size_t>( reg_e::ecx )] & 1 << 27 ) {
+			m_xcr0 = xgetbv( 0 );
+		}
+
 		// Get features string
 		for ( const auto & feat : m_features ) {
 			if ( m_funcs[feat.fun][static_cast<size_t>( feat.reg )] & 1 << feat.bit ) {
@@ -99,10 +131,16 @@ public:
 	//bool sse42()	const { return m_funcs[1][static_cast<size_t>( reg_e::ecx )] & 1 << 20; }
 	bool fma3()		const { return m_funcs[1][static_cast<size_t>( reg_e::ecx )] & 1 << 12; }
 	bool avx()		const { return m_funcs[1][static_cast<size_t>( reg_e::ecx )] & 1 << 28; }
+	bool f16c()		const { return m_funcs[1][static_cast<size_t>( reg_e::ecx )] & 1 << 29; }
 
 	bool avx2()		const { return m_funcs[7][static_cast<size_t>( reg_e::ebx )] & 1 <<  5; }
 	//bool bmi1()		const { return m_funcs[7][static_cast<size_t>( reg_e::ebx )] & 1 <<  3; }
 	//bool bmi2()		const { return m_funcs[7][static_cast<size_t>( reg_e::ebx )] & 1 <<  8; }
+	bool avx512f()	const { return m_funcs[7][static_cast<size_t>( reg_e::ebx )] & 1 << 16; }
+	bool avx512bw()	const { return m_funcs[7][static_cast<size_t>( reg_e::ebx )] & 1 << 30; }
+
+	// OS saves SSE, AVX and AVX-512 (opmask, ZMM0-15 upper halves, ZMM16-31) registers: XCR0 bits 1, 2, 5, 6, 7
+	bool os_avx512()	const { return (m_xcr0 & 0xe6) == 0xe6; }
 
 	//bool sse4a()	const { return m_funcs_ext[1][static_cast<size_t>( reg_e::ecx )] & 1 <<  6; }
 	//bool fma4()		const { return m_funcs_ext[1][static_cast<size_t>( reg_e::ecx )] & 1 << 16; }
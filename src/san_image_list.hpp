@@ -16,12 +16,16 @@ public:
 
 		// Load all JPEGs from diretory...
 		for ( auto & p : std::filesystem::recursive_directory_iterator( path ) ) {
+			std::shared_ptr <surface> image;
 			if ( p.path().extension() == ".jpg" || p.path().extension() == ".png" ) { // JPEG and PNG only
 				std::printf( "Loading '%s'...\n", p.path().string().c_str() );
-				std::shared_ptr <surface> image = load_image( p.path().string().c_str() );
-				if ( image ) {
-					m_images.push_back( image );
-				}
+				image = load_image( p.path().string().c_str() );
+			} else if ( p.path().extension() == ".bgra" ) { // Raw images are mapped (copy-on-write)
+				std::printf( "Mapping '%s'...\n", p.path().string().c_str() );
+				image = map_raw_image( p.path().string().c_str() );
+			}
+			if ( image ) {
+				m_images.push_back( image );
 			}
 		}
 
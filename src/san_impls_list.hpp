@@ -20,15 +20,134 @@ class impls_list {
 
 	using simd_calc_sse2	= san::blur::stack::simd::sse128_u32_t<2>;
 	using simd_calc_sse41	= san::blur::stack::simd::sse128_u32_t<41>;
+	using simd_calc_wide	= san::blur::stack::simd::sse128_u32_wide_t;
+	using simd_calc_rgba16	= san::blur::stack::simd::sse128_u32_rgba16_t;
 
 	san::blur::stack::simd::optimized_1 <simd_calc_sse41>					m_san_opt_1;
 	san::blur::stack::simd::optimized_2 <simd_calc_sse41>					m_san_opt_2;
+	san::blur::stack::simd::tiled <simd_calc_sse41, 16>						m_san_tiled;
+	san::blur::stack::simd::optimized_2 <simd_calc_wide>					m_san_opt_2_wide;
+	san::blur::stack::simd::tiled <simd_calc_wide, 16>						m_san_tiled_wide;
+	san::blur::stack::simd::optimized_2 <simd_calc_rgba16>					m_san_opt_2_rgba16;
+	san::blur::stack::simd::tiled <simd_calc_rgba16, 16>					m_san_tiled_rgba16;
+#if defined( SAN_PIXEL_F16C )
+	san::blur::stack::simd::optimized_2 <san::blur::stack::simd::sse128_f32_rgba16f_t>	m_san_opt_2_rgba16f;
+	san::blur::stack::simd::tiled <san::blur::stack::simd::sse128_f32_rgba16f_t, 16>	m_san_tiled_rgba16f;
+#endif
+	san::blur::stack::simd::small_radius <san::blur::stack::simd::sse128_u16_t, san::blur::stack::simd::tiled <simd_calc_sse41, 16>>	m_san_small;
+#if defined( __AVX2__ )
+	san::blur::stack::simd::small_radius <san::blur::stack::simd::avx256_u16_t, san::blur::stack::simd::tiled <simd_calc_sse41, 16>>	m_san_small_avx2;
+#endif
+	san::blur::stack::simd::premultiplied <simd_calc_sse41, 16, true>		m_san_premul;
+	san::blur::stack::simd::premultiplied <simd_calc_sse41, 16, false>		m_san_premul_separate;
+	san::blur::stack::simd::fractional <simd_calc_sse41, 16>				m_san_fractional;
+	san::blur::stack::simd::motion <simd_calc_sse41>						m_san_motion_0   {   0.f };
+	san::blur::stack::simd::motion <simd_calc_sse41>						m_san_motion_30  {  30.f };
+	san::blur::stack::simd::motion <simd_calc_sse41>						m_san_motion_100 { 100.f };
+	san::blur::stack::simd::transposed <simd_calc_sse41, 16>				m_san_transposed;
+	san::blur::stack::simd::fused <simd_calc_sse41, 16, 16>					m_san_fused;
+	san::blur::stack::simd::streamed <simd_calc_sse41>						m_san_streamed;
+	san::blur::stack::simd::batched <simd_calc_sse41, 16>					m_san_batched;
+	san::blur::stack::simd::incremental <simd_calc_sse41, 16>				m_san_incremental;
+	std::unique_ptr <san::surface>											m_incremental_out;		// Output kept between frames
+	int																		m_incremental_frame = 0;
+	san::blur::box::cascaded <simd_calc_sse41, 3>							m_box_cascaded_3;
+	san::blur::box::cascaded <simd_calc_sse41, 5>							m_box_cascaded_5;
+	san::blur::sat::box														m_sat_box;
+	san::blur::sat::variable												m_sat_variable;
+	std::unique_ptr <san::surface>											m_vignette_map;			// Radius map of 'm_sat_variable'
+	san::blur::pyramid::mip_chain <san::blur::stack::simd::tiled <simd_calc_sse41, 16>>	m_pyramid;
+#if defined( __AVX2__ )
+	san::blur::stack::simd::optimized_3 <san::blur::stack::simd::avx256_u32_t>	m_san_opt_3;
+#endif
+	san::blur::stack::simd::optimized_4 <san::blur::stack::simd::avx512_u32_t>	m_san_opt_4;
 
 	agg::stack_blur <agg::rgba8, agg::stack_blur_calc_rgba<uint32_t>>		m_agg_stack_blur;
 	agg::recursive_blur	<agg::rgba8, agg::recursive_blur_calc_rgba<double>>	m_agg_recursive_blur;
 
 	san::blur::gaussian::naive_test <256, float>							m_gaussian_naive;
+	san::blur::gaussian::kernel_cache										m_gaussian_kernels;
+	san::blur::gaussian::simd <san::blur::gaussian::sse128_madd_t>			m_gaussian_simd			{ m_gaussian_kernels };
+#if defined( __AVX2__ )
+	san::blur::gaussian::simd <san::blur::gaussian::avx256_madd_t>			m_gaussian_simd_avx2	{ m_gaussian_kernels };
+#endif
+	san::blur::a8::stack <san::blur::a8::sse128_u32x16_t>					m_a8_stack;
+	san::blur::a8::box <san::blur::a8::sse128_u32x16_t>						m_a8_box;
+#if defined( __AVX2__ )
+	san::blur::a8::stack <san::blur::a8::avx256_u32x16_t>					m_a8_stack_avx2;
+	san::blur::a8::box <san::blur::a8::avx256_u32x16_t>						m_a8_box_avx2;
+#endif
 	san::blur::recursive::naive <>											m_recursive_naive;
+	san::blur::recursive::simd <san::blur::recursive::sse128_f32_t>			m_recursive_simd;
+#if defined( __AVX2__ )
+	san::blur::recursive::simd <san::blur::recursive::avx256_f32_t>			m_recursive_simd_avx2;
+	san::blur::recursive::simd <san::blur::recursive::avx256_f64_t>			m_recursive_simd_avx2_f64;
+#endif
+
+	// Central third of image (1/9 of its area), rectangle is set by constructor.
+	san::blur::roi::clipped <san::blur::stack::simd::tiled <simd_calc_sse41, 16>>		m_roi_tiled				{ {} };
+	san::blur::roi::clipped <san::blur::gaussian::simd <san::blur::gaussian::sse128_madd_t>>	m_roi_gaussian_simd	{ {}, san::blur::gaussian::simd <san::blur::gaussian::sse128_madd_t>( m_gaussian_kernels ) };
+	san::blur::roi::clipped <san::blur::recursive::simd <san::blur::recursive::sse128_f32_t>, 150>	m_roi_recursive_simd	{ {} };
+
+	// 'size' x 'size' sprites covering image, the last column and row of them may be smaller.
+	static std::list <san::surface_view> split_to_sprites( san::surface_view & image, int size ) {
+		std::list <san::surface_view> sprites;
+		for ( int y = 0; y < image.height(); y += size ) {
+			for ( int x = 0; x < image.width(); x += size ) {
+				sprites.emplace_back( image, x, y, std::min( size, image.width() - x ), std::min( size, image.height() - y ) );
+			}
+		}
+		return sprites;
+	}
+
+	// Implementations for 16-bit and half-float pixels (see 'san_pixel.hpp'), they need SSE4.1 (and F16C for half-floats).
+	void emplace_wide_formats( const san::cpu_info & cpu_info, san::surface_view & surface_view_san, san::parallel_for & a_parallel_for ) {
+		const san::pixel_format format = surface_view_san.format();
+		if ( !cpu_info.sse41() ) return;
+
+		if ( format == san::pixel_format::rgba16 ) {
+			EMPLACE_IMPL_FUNCT( "san::blur::stack::naive (64-bit)",				surface_view_san, (san::blur::stack::naive<san::blur::stack::naive_calc_wide, san::parallel_for, san::pixel::rgba16>) )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::optimized_2 (SSE4.1, 16-bit)",	surface_view_san, m_san_opt_2_rgba16 )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::tiled (SSE4.1, 16-bit)",	surface_view_san, m_san_tiled_rgba16 )
+		} else if ( format == san::pixel_format::rgba16f ) {
+#if defined( SAN_PIXEL_F16C )
+			if ( !cpu_info.f16c() ) return;
+			EMPLACE_IMPL_FUNCT( "san::blur::stack::naive (double)",				surface_view_san, (san::blur::stack::naive<san::blur::stack::naive_calc_float, san::parallel_for, san::pixel::rgba16f>) )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::optimized_2 (F16C)",	surface_view_san, m_san_opt_2_rgba16f )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::tiled (F16C)",			surface_view_san, m_san_tiled_rgba16f )
+#else
+			return;
+#endif
+		}
+
+		// These take pixels of any format...
+		EMPLACE_IMPL_CLASS( "san::blur::gaussian::naive",						surface_view_san, m_gaussian_naive )
+		EMPLACE_IMPL_CLASS( "san::blur::recursive::simd (SSE4.1)",				surface_view_san, m_recursive_simd )
+
+#if defined( __AVX2__ )
+		if ( cpu_info.avx2() ) {
+			EMPLACE_IMPL_CLASS( "san::blur::recursive::simd (AVX2)",			surface_view_san, m_recursive_simd_avx2 )
+			EMPLACE_IMPL_CLASS( "san::blur::recursive::simd (AVX2, double)",	surface_view_san, m_recursive_simd_avx2_f64 )
+		}
+#endif
+	}
+
+	// Implementations for single-channel 8-bit images (see 'san_blur_a8.hpp').
+	void emplace_a8( const san::cpu_info & cpu_info, san::surface_view & surface_view_san, san::parallel_for & a_parallel_for ) {
+		EMPLACE_IMPL_FUNCT( "san::blur::stack::naive",							surface_view_san, (san::blur::stack::naive<san::blur::stack::naive_calc<>, san::parallel_for, uint8_t>) )
+
+		if ( cpu_info.sse41() ) {
+			EMPLACE_IMPL_CLASS( "san::blur::a8::stack (SSE4.1)",				surface_view_san, m_a8_stack )
+			EMPLACE_IMPL_CLASS( "san::blur::a8::box (SSE4.1, 3 boxes)",			surface_view_san, m_a8_box )
+		}
+
+#if defined( __AVX2__ )
+		if ( cpu_info.avx2() ) {
+			EMPLACE_IMPL_CLASS( "san::blur::a8::stack (AVX2)",					surface_view_san, m_a8_stack_avx2 )
+			EMPLACE_IMPL_CLASS( "san::blur::a8::box (AVX2, 3 boxes)",			surface_view_san, m_a8_box_avx2 )
+		}
+#endif
+	}
 
 public:
 	impls_list(
@@ -37,13 +156,35 @@ public:
 		san::adaptor::agg_image & surface_view_agg,
 		san::parallel_for & a_parallel_for )
 	{
+		// Only some implementations take pixels other than 32bpp.
+		if ( surface_view_san.components() == 1 ) {
+			emplace_a8( cpu_info, surface_view_san, a_parallel_for );
+			return;
+		}
+
+		if ( surface_view_san.format() != san::pixel_format::rgba8 ) {
+			emplace_wide_formats( cpu_info, surface_view_san, a_parallel_for );
+			return;
+		}
+
+		const san::blur::roi::rect central_third { surface_view_san.width() / 3, surface_view_san.height() / 3,
+			surface_view_san.width() / 3, surface_view_san.height() / 3 };
+		m_roi_tiled.set_rect( central_third );
+		m_roi_gaussian_simd.set_rect( central_third );
+		m_roi_recursive_simd.set_rect( central_third );
 
 		EMPLACE_IMPL_FUNCT( "agg::stack_blur_rgba32",							surface_view_agg, (agg::stack_blur_rgba32<san::adaptor::agg_image, san::parallel_for>) )
 		EMPLACE_IMPL_CLASS( "agg::stack_blur",									surface_view_agg, m_agg_stack_blur )
 		EMPLACE_IMPL_CLASS( "agg::recursive_blur",								surface_view_agg, m_agg_recursive_blur )
+		EMPLACE_IMPL_FUNCT( "agg::stack_blur (bounded adaptor, central 1/9, no halo)",	surface_view_san,
+			([this]( san::surface_view & image, san::parallel_for & pf, float radius, int threads ) {
+				san::adaptor::agg_image bounded( image, image.width() / 3, image.height() / 3, image.width() / 3, image.height() / 3 );
+				m_agg_stack_blur( bounded, pf, int(radius), threads );
+			}) )
 		EMPLACE_IMPL_CLASS( "san::blur::gaussian::naive",						surface_view_san, m_gaussian_naive )
 		EMPLACE_IMPL_CLASS( "san::blur::recursive::naive",						surface_view_san, m_recursive_naive )
 		EMPLACE_IMPL_FUNCT( "san::blur::stack::naive",							surface_view_san, (san::blur::stack::naive<san::blur::stack::naive_calc<>, san::parallel_for>) )
+		EMPLACE_IMPL_FUNCT( "san::blur::stack::naive (64-bit)",				surface_view_san, (san::blur::stack::naive<san::blur::stack::naive_calc_wide, san::parallel_for>) )
 
 		if ( cpu_info.sse2() ) {
 			EMPLACE_IMPL_FUNCT( "san::blur::stack::simd::naive (SSE2)",			surface_view_san, (san::blur::stack::simd::naive<simd_calc_sse2 , san::parallel_for>) )
@@ -53,6 +194,103 @@ public:
 			EMPLACE_IMPL_FUNCT( "san::blur::stack::simd::naive (SSE4.1)",		surface_view_san, (san::blur::stack::simd::naive<simd_calc_sse41, san::parallel_for>) )
 			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::optimized_1 (SSE4.1)",	surface_view_san, m_san_opt_1 )
 			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::optimized_2 (SSE4.1)",	surface_view_san, m_san_opt_2 )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::tiled (SSE4.1)",		surface_view_san, m_san_tiled )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::optimized_2 (SSE4.1, wide)",	surface_view_san, m_san_opt_2_wide )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::tiled (SSE4.1, wide)",	surface_view_san, m_san_tiled_wide )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::small_radius (SSE4.1, 16-bit, tiled above 14)",	surface_view_san, m_san_small )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::premultiplied (SSE4.1, fused)",	surface_view_san, m_san_premul )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::premultiplied (SSE4.1, separate passes)",	surface_view_san, m_san_premul_separate )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::fractional (SSE4.1)",	surface_view_san, m_san_fractional )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::motion (SSE4.1, 0 deg)",	surface_view_san, m_san_motion_0 )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::motion (SSE4.1, 30 deg)",	surface_view_san, m_san_motion_30 )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::motion (SSE4.1, 100 deg)",	surface_view_san, m_san_motion_100 )
+			EMPLACE_IMPL_FUNCT( "san::blur::stack::simd::tiled (SSE4.1, anisotropic, Y radius / 4)",	surface_view_san,
+				([this]( san::surface_view & image, san::parallel_for & pf, float radius, int threads ) {
+					m_san_tiled.blur_xy( image, pf, int(radius), int(radius) / 4, threads );
+				}) )
+			EMPLACE_IMPL_FUNCT( "san::blur::box::cascaded (SSE4.1, 3 boxes, anisotropic, Y radius / 4)",	surface_view_san,
+				([this]( san::surface_view & image, san::parallel_for & pf, float radius, int threads ) {
+					m_box_cascaded_3.blur_xy( image, pf, int(radius), int(radius) / 4, threads );
+				}) )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::transposed (SSE4.1)",	surface_view_san, m_san_transposed )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::fused (SSE4.1)",		surface_view_san, m_san_fused )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::stream (SSE4.1)",		surface_view_san, m_san_streamed )
+			EMPLACE_IMPL_FUNCT( "san::blur::stack::simd::batched (SSE4.1, 64x64 sprites)",	surface_view_san,
+				([this]( san::surface_view & image, san::parallel_for & pf, float radius, int threads ) {
+					std::list <san::surface_view> sprites = split_to_sprites( image, 64 );
+					std::vector <san::blur::stack::simd::batch_job <san::surface_view>> jobs;
+					jobs.reserve( sprites.size() );
+					for ( san::surface_view & sprite : sprites ) jobs.push_back( { &sprite, int(radius) } );
+					m_san_batched.run( jobs.data(), int(jobs.size()), pf, threads );
+				}) )
+			EMPLACE_IMPL_FUNCT( "san::blur::stack::simd::incremental (SSE4.1, 64x64 dirty rect of static frame)",	surface_view_san,
+				([this]( san::surface_view & image, san::parallel_for & pf, float radius, int threads ) {
+					if ( !m_incremental_out || m_incremental_out->width() != image.width() || m_incremental_out->height() != image.height() ) {
+						m_incremental_out.reset( new (std::nothrow) san::surface( image.width(), image.height(), image.components(), image.format() ) );
+						if ( !m_incremental_out || !*m_incremental_out ) {
+							m_incremental_out.reset();
+							return;
+						}
+					}
+
+					// Rectangle (cursor) moves over unchanged frame, output is copied back as window's backbuffer is.
+					int n = m_incremental_frame++;
+					const san::blur::roi::rect dirty { (n * 37) % image.width(), (n * 23) % image.height(), 64, 64 };
+					san::surface_view out( *m_incremental_out );
+					m_san_incremental.update( image, out, dirty, pf, int(radius), threads );
+					out.blit_to( image );
+				}) )
+			EMPLACE_IMPL_FUNCT( "san::blur::stack::simd::tiled (SSE4.1, 64x64 sprites one by one)",	surface_view_san,
+				([this]( san::surface_view & image, san::parallel_for & pf, float radius, int threads ) {
+					for ( san::surface_view & sprite : split_to_sprites( image, 64 ) ) {
+						m_san_tiled( sprite, pf, int(radius), threads );
+					}
+				}) )
+			EMPLACE_IMPL_CLASS( "san::blur::box::cascaded (SSE4.1, 3 boxes)",	surface_view_san, m_box_cascaded_3 )
+			EMPLACE_IMPL_CLASS( "san::blur::box::cascaded (SSE4.1, 5 boxes)",	surface_view_san, m_box_cascaded_5 )
+			EMPLACE_IMPL_CLASS( "san::blur::sat::box (SSE4.1)",					surface_view_san, m_sat_box )
+			EMPLACE_IMPL_FUNCT( "san::blur::sat::variable (SSE4.1, vignette, radius at corners)",	surface_view_san,
+				([this]( san::surface_view & image, san::parallel_for & pf, float radius, int threads ) {
+					if ( !m_vignette_map || m_vignette_map->width() != image.width() || m_vignette_map->height() != image.height() ) {
+						m_vignette_map.reset( new (std::nothrow) san::surface( image.width(), image.height(), 1 ) );
+						if ( !m_vignette_map || !*m_vignette_map ) {
+							m_vignette_map.reset();
+							return;
+						}
+
+						// Sharp center, 255 at corners (square of distance from center).
+						const float cx = (image.width() - 1) * .5f, cy = (image.height() - 1) * .5f;
+						const float norm = 255.f / std::max( cx * cx + cy * cy, 1.f );
+						for ( int y = 0; y < image.height(); y++ ) {
+							uint8_t * p = m_vignette_map->row_ptr( y );
+							for ( int x = 0; x < image.width(); x++ ) {
+								p[x] = uint8_t(((x - cx) * (x - cx) + (y - cy) * (y - cy)) * norm + .5f);
+							}
+						}
+					}
+
+					m_sat_variable( image, *m_vignette_map, radius / 255.f, pf, threads );
+				}) )
+			EMPLACE_IMPL_CLASS( "san::blur::pyramid::mip_chain (SSE4.1)",		surface_view_san, m_pyramid )
+			EMPLACE_IMPL_CLASS( "san::blur::recursive::simd (SSE4.1)",			surface_view_san, m_recursive_simd )
+			EMPLACE_IMPL_CLASS( "san::blur::gaussian::simd (SSE4.1)",			surface_view_san, m_gaussian_simd )
+			EMPLACE_IMPL_CLASS( "san::blur::roi::clipped (tiled, SSE4.1, central 1/9)",				surface_view_san, m_roi_tiled )
+			EMPLACE_IMPL_CLASS( "san::blur::roi::clipped (gaussian::simd, SSE4.1, central 1/9)",	surface_view_san, m_roi_gaussian_simd )
+			EMPLACE_IMPL_CLASS( "san::blur::roi::clipped (recursive::simd, SSE4.1, central 1/9)",	surface_view_san, m_roi_recursive_simd )
+		}
+
+#if defined( __AVX2__ )
+		if ( cpu_info.avx2() ) {
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::optimized_3 (AVX2)",	surface_view_san, m_san_opt_3 )
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::small_radius (AVX2, 16-bit, tiled above 14)",	surface_view_san, m_san_small_avx2 )
+			EMPLACE_IMPL_CLASS( "san::blur::recursive::simd (AVX2)",			surface_view_san, m_recursive_simd_avx2 )
+			EMPLACE_IMPL_CLASS( "san::blur::recursive::simd (AVX2, double)",	surface_view_san, m_recursive_simd_avx2_f64 )
+			EMPLACE_IMPL_CLASS( "san::blur::gaussian::simd (AVX2)",				surface_view_san, m_gaussian_simd_avx2 )
+		}
+#endif
+
+		if ( cpu_info.avx512f() && cpu_info.avx512bw() && cpu_info.os_avx512() ) {
+			EMPLACE_IMPL_CLASS( "san::blur::stack::simd::optimized_4 (AVX-512)",	surface_view_san, m_san_opt_4 )
 		}
 	}
 
@@ -1,6 +1,18 @@
 //
 // Tiny parallel 'for' loop thread pool implementation.
-// Based on 'BS_thread_pool_light.hpp' library by Barak Shoshany - https://github.com/bshoshany/thread-pool/blob/master/BS_thread_pool_light.hpp
+// Originally based on 'BS_thread_pool_light.hpp' library by Barak Shoshany - https://github.com/bshoshany/thread-pool/blob/master/BS_thread_pool_light.hpp
+//
+// Work-stealing version. Every 'run()' is a job placed into one of fixed job slots (no allocation for small callables).
+// Job's range is cut into chunks, which are spread over per-worker deques. Each deque is a packed [lo;hi) range of chunk
+// indices in a single 64-bit atomic: owner pops from 'lo', thieves steal from 'hi', both by CAS.
+// Idle workers spin, then yield, then park on condition variable. Thread, which waits, helps to execute chunks.
+//
+// Besides static split, chunks may be handed out dynamically from job's atomic counter ('set_schedule()'):
+//  - dynamic: fixed chunks of 'grain' items;
+//  - guided:  chunks of remaining / (2 * threads) items, but not less than 'grain'.
+// This is slower for perfectly balanced loops, but doesn't wait for preempted or slow cores.
+//
+// 'run()' and 'wait()' are expected to be called from one (not pool's) thread.
 //
 
 #pragma once
@@ -8,62 +20,223 @@
 namespace san {
 
 class parallel_for {
+public:
+	enum class schedule_e : uint8_t { static_split, dynamic, guided };
+
+private:
+	static constexpr int	max_jobs		= 8;	// Max. number of 'run()' calls not waited yet
+	static constexpr int	callable_size	= 64;	// Bigger callables are allocated on heap
+	static constexpr int	spin_count		= 512;
+	static constexpr int	yield_count		= 16;
+
+	struct job {
+		std::atomic <bool>	active			= false;
+		std::atomic <int>	remaining		= 0;	// Items left to finish
+
+		int					beg;
+		int					end;
+		int					block_size;
+		int					rem;
+
+		// Dynamic and guided schedules
+		schedule_e			schedule;
+		int					grain;
+		int					max_threads;
+		std::atomic <int>	next			= 0;	// Next item to hand out
+		std::atomic <int>	joined			= 0;	// Threads which took part
+
+		void			 (*	invoke )( void *, int, int );
+		void			 (*	destroy )( void * );
+		void *				p_callable;
+		alignas( std::max_align_t ) unsigned char storage[callable_size];
+
+		// Same distribution as before: remainder is spread over first chunks
+		int chunk_beg( int i ) const { return beg + i * block_size + std::min( i, rem ); }
+		int chunk_end( int i ) const { return chunk_beg( i ) + block_size + (i < rem ? 1 : 0); }
+	}; // struct job
+
+	// Packed [lo;hi) range of chunk indices. Own cache line for each to avoid false sharing.
+	struct alignas( 64 ) deque {
+		std::atomic <uint64_t>	range	= 0;
+		std::atomic <bool>		joined	= false;	// Thread takes part in dynamic job
+
+		static uint64_t	pack( uint32_t lo, uint32_t hi ) { return uint64_t(hi) << 32 | lo; }
+		static uint32_t	lo( uint64_t r ) { return uint32_t(r); }
+		static uint32_t	hi( uint64_t r ) { return uint32_t(r >> 32); }
+
+		// Owner's side. Returns chunk index or -1.
+		int pop() {
+			uint64_t r = range.load();
+			while ( lo( r ) < hi( r ) ) {
+				if ( range.compare_exchange_weak( r, pack( lo( r ) + 1, hi( r ) ) ) ) return lo( r );
+			}
+			return -1;
+		}
+
+		// Thief's side. Takes the last chunk. Returns chunk index or -1.
+		int steal() {
+			uint64_t r = range.load();
+			while ( lo( r ) < hi( r ) ) {
+				if ( range.compare_exchange_weak( r, pack( lo( r ), hi( r ) - 1 ) ) ) return hi( r ) - 1;
+			}
+			return -1;
+		}
+	}; // struct deque
+
 	int									m_size;
 	std::unique_ptr <std::thread[]>		m_workers;
 
 	std::atomic <bool>					m_running		= false;
-	std::atomic <bool>					m_waiting		= false;
 
-	std::queue <std::function<void()>>	m_tasks;
-	std::atomic <size_t>				m_tasks_total	= 0;
+	job									m_jobs[max_jobs];
+	std::unique_ptr <deque[]>			m_deques;		// [max_jobs][m_size + 1], last one is for waiting thread
+	std::atomic <int>					m_jobs_active	= 0;
 
-	mutable std::mutex					m_tasks_mutex;
+	std::mutex							m_park_mutex;
 	std::condition_variable				m_task_available_cv;
 	std::condition_variable				m_task_done_cv;
+	std::atomic <uint32_t>				m_epoch			= 0;	// Incremented on every new job
+	std::atomic <int>					m_sleepers		= 0;
+	std::atomic <int>					m_waiters		= 0;
+
+	schedule_e							m_schedule		= schedule_e::static_split;
+	int									m_grain			= 1;
 
 	parallel_for( const parallel_for & ) = delete;
 	parallel_for & operator = ( const parallel_for & ) = delete;
 
-	void worker() {
-		while ( m_running ) {
+	deque & get_deque( int i_job, int i_thread ) { return m_deques[i_job * (m_size + 1) + i_thread]; }
+
+	void execute( int i_job, int a, int b ) {
+		job & j = m_jobs[i_job];
+		j.invoke( j.p_callable, a, b );
+
+		if ( j.remaining.fetch_sub( b - a ) == b - a ) {
+			j.destroy( j.p_callable );
+			j.active = false;
+			if ( m_jobs_active.fetch_sub( 1 ) == 1 && m_waiters.load() > 0 ) {
+				const std::scoped_lock lock( m_park_mutex );
+				m_task_done_cv.notify_all();
+			}
+		}
+	}
+
+	// Takes next chunk of dynamic or guided job. Counter of static jobs is always exhausted.
+	bool claim( int i_job, int self, int & a, int & b ) {
+		job & j = m_jobs[i_job];
+		if ( j.next.load() >= j.end ) return false;
+
+		// Limit number of threads for 'override_num_threads'.
+		deque & d = get_deque( i_job, self );
+		if ( !d.joined ) {
+			if ( j.joined.load() >= j.max_threads || j.joined.fetch_add( 1 ) >= j.max_threads ) return false;
+			d.joined = true;
+		}
 
-			std::unique_lock <std::mutex> tasks_lock( m_tasks_mutex );
-			m_task_available_cv.wait( tasks_lock, [this]{ return !m_tasks.empty() || !m_running; } );
+		if ( j.schedule == schedule_e::guided ) {
+			a = j.next.load();
+			while ( a < j.end ) {
+				b = std::min( j.end, a + std::max( j.grain, (j.end - a) / (2 * j.max_threads) ) );
+				if ( j.next.compare_exchange_weak( a, b ) ) return true;
+			}
+			return false;
+		}
+
+		a = j.next.fetch_add( j.grain );
+		b = std::min( j.end, a + j.grain );
+		return a < j.end;
+	}
 
-			if ( m_running ) {
-				std::function <void()> task( std::move( m_tasks.front() ) );
-				m_tasks.pop();
+	// Runs one chunk from own deque, stolen from others or from counter. Returns false if there is no work.
+	bool run_one( int self ) {
+		for ( int i = 0; i < max_jobs; i++ ) {
+			if ( !m_jobs[i].active ) continue;
+			int i_chunk = get_deque( i, self ).pop();
+			if ( i_chunk >= 0 ) {
+				execute( i, m_jobs[i].chunk_beg( i_chunk ), m_jobs[i].chunk_end( i_chunk ) );
+				return true;
+			}
 
-				tasks_lock.unlock();
-				task();
-				tasks_lock.lock();
+			int a, b;
+			if ( claim( i, self, a, b ) ) {
+				execute( i, a, b );
+				return true;
+			}
+		}
 
-				--m_tasks_total;
-				if ( m_waiting ) {
-					m_task_done_cv.notify_one();
+		for ( int i = 0; i < max_jobs; i++ ) {
+			if ( !m_jobs[i].active ) continue;
+			for ( int k = 1; k <= m_size; k++ ) {
+				int i_chunk = get_deque( i, (self + k) % (m_size + 1) ).steal();
+				if ( i_chunk >= 0 ) {
+					execute( i, m_jobs[i].chunk_beg( i_chunk ), m_jobs[i].chunk_end( i_chunk ) );
+					return true;
 				}
 			}
 		}
+		return false;
+	}
+
+	void worker( int self ) {
+		int idle = 0;
+		while ( m_running ) {
+			if ( run_one( self ) ) {
+				idle = 0;
+			} else if ( ++idle < spin_count ) {
+				_mm_pause();
+			} else if ( idle < spin_count + yield_count ) {
+				std::this_thread::yield();
+			} else {
+				idle = 0;
+
+				// Epoch is taken before the last check, so a job posted after it will wake us up.
+				uint32_t epoch = m_epoch;
+				if ( run_one( self ) ) continue;
+
+				std::unique_lock <std::mutex> lock( m_park_mutex );
+				++m_sleepers;
+				m_task_available_cv.wait( lock, [&]{ return m_epoch != epoch || !m_running; } );
+				--m_sleepers;
+			}
+		}
+	}
+
+	template <typename F>
+	static void invoke_callable( void * p, int a, int b ) { (*static_cast<F *>( p ))( a, b ); }
+
+	template <typename F>
+	static void destroy_callable( void * p ) {
+		if constexpr ( sizeof( F ) <= callable_size && alignof( F ) <= alignof( std::max_align_t ) ) {
+			static_cast<F *>( p )->~F();
+		} else {
+			delete static_cast<F *>( p );
+		}
 	}
 
 public:
 	parallel_for( int n_threads = std::thread::hardware_concurrency() )
 		: m_size( n_threads )
 		, m_workers( new (std::nothrow) std::thread [m_size] )
+		, m_deques( new (std::nothrow) deque [max_jobs * (m_size + 1)] )
 	{
 		assert( !!m_workers );
+		assert( !!m_deques );
 		assert( m_size > 0 );
 
 		m_running = true;
 		for ( int i = 0; i < m_size; i++ ) {
-			m_workers[i] = std::thread( &parallel_for::worker, this );
+			m_workers[i] = std::thread( &parallel_for::worker, this, i );
 		}
 	}
 
 	virtual ~parallel_for() {
 		wait();
 		m_running = false;
-		m_task_available_cv.notify_all();
+		{
+			const std::scoped_lock lock( m_park_mutex );
+			++m_epoch;
+			m_task_available_cv.notify_all();
+		}
 		for ( int i = 0; i < m_size; ++i ) {
 			m_workers[i].join();
 		}
@@ -71,44 +244,102 @@ public:
 
 	int num_threads() const { return m_size; }
 
+	// Applies to loops posted after the call. 'grain' - min. number of items in a chunk for dynamic schedules.
+	void set_schedule( schedule_e schedule, int grain = 1 ) {
+		m_schedule = schedule;
+		m_grain    = grain > 0 ? grain : 1;
+	}
+
+	schedule_e	schedule() const { return m_schedule; }
+	int			grain()    const { return m_grain; }
+
 	void wait() {
-		m_waiting = true;
-		std::unique_lock <std::mutex> tasks_lock( m_tasks_mutex );
-		m_task_done_cv.wait( tasks_lock, [this]{ return !m_tasks_total; } );
-		m_waiting = false;
+		int idle = 0;
+		while ( m_jobs_active ) {
+			if ( run_one( m_size ) ) {
+				idle = 0;
+			} else if ( ++idle < spin_count ) {
+				_mm_pause();
+			} else if ( idle < spin_count + yield_count ) {
+				std::this_thread::yield();
+			} else {
+				std::unique_lock <std::mutex> lock( m_park_mutex );
+				++m_waiters;
+				m_task_done_cv.wait( lock, [this]{ return !m_jobs_active; } );
+				--m_waiters;
+			}
+		}
 	}
 
 	template <typename F>
 	void run( int beg, int end, F && f, int override_num_threads = 0 ) {
 		if ( beg >= end ) return;
 
-		int n_threads = override_num_threads > 0 ? override_num_threads : m_size;
+		using callable_t = std::decay_t <F>;
 
 		int total_size	= end - beg;
-		int block_size	= total_size / n_threads;
-		int rem			= total_size % n_threads;
-
-		while ( n_threads-- > 0 ) {
-			int curr_size = rem > 0 ? block_size + 1 : block_size;
+		int n_threads	= override_num_threads > 0 ? override_num_threads : m_size;
+		int n_chunks	= n_threads;
+		if ( n_chunks > total_size ) n_chunks = total_size;	// No empty chunks
 
-#ifndef NDEBUG
-			if ( !curr_size ) {
-				std::fprintf( stderr, "%s: zero size block (n_threads = %d). Thread count > loop size?\n", __FUNCTION__, n_threads );
-				assert( n_threads == 0 );
-				break;
+		// Get free job slot, help others while there is no one.
+		int i_job = -1;
+		while ( i_job < 0 ) {
+			for ( int i = 0; i < max_jobs; i++ ) {
+				if ( !m_jobs[i].active ) { i_job = i; break; }
 			}
-#endif
+			if ( i_job < 0 && !run_one( m_size ) ) std::this_thread::yield();
+		}
 
-			{ // Push task...
-				const std::scoped_lock tasks_lock( m_tasks_mutex );
-				m_tasks.push( std::bind( std::forward<F>( f ), beg, beg + curr_size ) );
-			}
+		job & j = m_jobs[i_job];
+		j.beg			= beg;
+		j.end			= end;
+		j.block_size	= total_size / n_chunks;
+		j.rem			= total_size % n_chunks;
+		j.schedule		= m_schedule;
+		j.grain			= m_grain;
+		j.max_threads	= n_threads;
+		j.joined		= 0;
+		j.next			= end;	// Exhausted until published
+		j.invoke		= &invoke_callable <callable_t>;
+		j.destroy		= &destroy_callable<callable_t>;
 
-			beg += curr_size;
-			rem--;
+		if constexpr ( sizeof( callable_t ) <= callable_size && alignof( callable_t ) <= alignof( std::max_align_t ) ) {
+			j.p_callable = new (j.storage) callable_t( std::forward<F>( f ) );
+		} else {
+			j.p_callable = new (std::nothrow) callable_t( std::forward<F>( f ) );
+			assert( j.p_callable );
+		}
+
+		j.remaining = total_size;
+
+		// Job must be counted before any of its chunks become visible.
+		// Deques of a free slot are empty, because all chunks of previous job were taken.
+		++m_jobs_active;
+		j.active = true;
+
+		for ( int i = 0; i <= m_size; i++ ) get_deque( i_job, i ).joined = false;
 
-			++m_tasks_total;
-			m_task_available_cv.notify_one();
+		// Spread chunks over workers' deques, contiguous blocks for each one, or open the counter.
+		if ( m_schedule == schedule_e::static_split ) {
+			for ( int i = 0; i < m_size; i++ ) {
+				uint32_t lo = uint32_t(int64_t(n_chunks) *  i      / m_size);
+				uint32_t hi = uint32_t(int64_t(n_chunks) * (i + 1) / m_size);
+				get_deque( i_job, i ).range = deque::pack( lo, hi );
+			}
+		} else {
+			j.next = beg;
+		}
+
+		// Wake up sleeping workers, if any.
+		++m_epoch;
+		if ( m_sleepers > 0 ) {
+			const std::scoped_lock lock( m_park_mutex );
+			if ( n_chunks >= m_sleepers ) {
+				m_task_available_cv.notify_all();
+			} else {
+				for ( int i = 0; i < n_chunks; i++ ) m_task_available_cv.notify_one();
+			}
 		}
 	}
 
@@ -1,12 +1,14 @@
 ﻿#pragma once
 
 #include <cmath>
+#include <cstddef>				// std::max_align_t
 #include <cstring>				// std::memcpy
 #include <cstdio>
 #include <cstdint>
 #include <cassert>
 
 #include <string>
+#include <vector>
 #include <array>
 #include <list>
 #include <memory>				// std::shared_ptr
@@ -21,11 +23,17 @@
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <chrono>				// std::chrono::steady_clock
 
 #include "agg/agg_color_rgba.h"
 #include "agg/agg_blur.h"
 
 #include <emmintrin.h>
 #include <smmintrin.h>
+#include <immintrin.h>
 
-#include <intrin.h>				// __cpuid
+#if defined( _WIN32 )
+ #include <intrin.h>			// __cpuid, __cpuidex
+#else
+ #include <cpuid.h>				// __cpuid_count
+#endif
@@ -0,0 +1,240 @@
+#pragma once
+
+// Pixel types of 'pixel_format's. Pixel is one value, so implementations take its type as template parameter:
+//  'uint32_t'        - rgba8, four 8-bit components
+//  'pixel::rgba16'   - four 16-bit components
+//  'pixel::rgba16f'  - four half-floats (IEEE 754 binary16), converted by F16C instructions
+// Half-floats are available only if F16C is enabled for compiler ('-mf16c', '/arch:AVX2'). Requires SSE4.1.
+
+#if defined( __F16C__ ) || (defined( _MSC_VER ) && defined( __AVX2__ ))
+ #define SAN_PIXEL_F16C
+#endif
+
+namespace san::pixel {
+
+struct rgba16 {
+	uint16_t	c[4];
+};
+
+struct rgba16f {
+	uint16_t	c[4];	// Bits of half-floats
+};
+
+// Value of white, for conversions between formats
+template <typename PixelT> constexpr float max_value				= 255.f;
+template <>                constexpr float max_value <rgba16>		= 65535.f;
+template <>                constexpr float max_value <rgba16f>	= 1.f;
+
+inline const char * name( pixel_format format ) {
+	switch ( format ) {
+		case pixel_format::rgba16:	return "rgba16";
+		case pixel_format::rgba16f:	return "rgba16f";
+		default:					return "rgba8";
+	}
+}
+
+inline bool from_name( const std::string & s, pixel_format & format ) {
+	for ( auto f : { pixel_format::rgba8, pixel_format::rgba16, pixel_format::rgba16f } ) {
+		if ( s == name( f ) ) {
+			format = f;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Calls 'f( PixelT() )' with pixel type of 'format'. Returns false if format isn't supported by this build.
+template <typename F>
+bool visit( pixel_format format, F && f ) {
+	switch ( format ) {
+		case pixel_format::rgba8:	f( uint32_t() ); return true;
+		case pixel_format::rgba16:	f( rgba16() );   return true;
+		case pixel_format::rgba16f:
+#if defined( SAN_PIXEL_F16C )
+			f( rgba16f() );
+			return true;
+#else
+			std::fprintf( stderr, "%s: half-floats need F16C support enabled by compiler.\n", __FUNCTION__ );
+			return false;
+#endif
+	}
+	return false;
+}
+
+
+// Four components as floats
+inline __m128 load_ps( const uint32_t * p ) {
+	return _mm_cvtepi32_ps( _mm_cvtepu8_epi32( _mm_cvtsi32_si128( *p ) ) );
+}
+
+inline __m128 load_ps( const rgba16 * p ) {
+	return _mm_cvtepi32_ps( _mm_cvtepu16_epi32( _mm_loadl_epi64( (const __m128i *)p ) ) );
+}
+
+// Rounded to nearest, integer formats are saturated
+inline void store_ps( uint32_t * p, const __m128 & v ) {
+	__m128i i = _mm_cvtps_epi32( v );
+	i = _mm_packus_epi32( i, i );
+	*p = _mm_cvtsi128_si32( _mm_packus_epi16( i, i ) );
+}
+
+inline void store_ps( rgba16 * p, const __m128 & v ) {
+	__m128i i = _mm_cvtps_epi32( v );
+	_mm_storel_epi64( (__m128i *)p, _mm_packus_epi32( i, i ) );
+}
+
+#if defined( SAN_PIXEL_F16C )
+
+inline __m128 load_ps( const rgba16f * p ) {
+	return _mm_cvtph_ps( _mm_loadl_epi64( (const __m128i *)p ) );
+}
+
+inline void store_ps( rgba16f * p, const __m128 & v ) {
+	_mm_storel_epi64( (__m128i *)p, _mm_cvtps_ph( v, _MM_FROUND_TO_NEAREST_INT ) );
+}
+
+#endif // defined( SAN_PIXEL_F16C )
+
+
+// Components for scalar (naive) implementations
+template <typename PixelT, typename ValueT>
+void unpack( const PixelT & p, ValueT (&c)[4] ) {
+	alignas(16) float f[4];
+	_mm_store_ps( f, load_ps( &p ) );
+	for ( int i = 0; i < 4; i++ ) c[i] = ValueT(f[i]);
+}
+
+template <typename PixelT, typename ValueT>
+PixelT pack( const ValueT (&c)[4] ) {
+	PixelT p;
+	store_ps( &p, _mm_setr_ps( float(c[0]), float(c[1]), float(c[2]), float(c[3]) ) );
+	return p;
+}
+
+
+// Premultiplication of 32bpp pixel by its alpha (the high byte), rounded: 'c * a / 255'.
+inline uint32_t premultiply( uint32_t p ) {
+	__m128i v = _mm_cvtepu8_epi16( _mm_cvtsi32_si128( p ) );
+	__m128i a = _mm_blend_epi16( _mm_shufflelo_epi16( v, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _mm_set1_epi16( 255 ), 0x08 );	// Alpha is kept
+	__m128i x = _mm_add_epi16( _mm_mullo_epi16( v, a ), _mm_set1_epi16( 128 ) );
+	x = _mm_srli_epi16( _mm_add_epi16( x, _mm_srli_epi16( x, 8 ) ), 8 );	// 'x / 255' for 'x' up to '255 * 255 + 128'
+	return _mm_cvtsi128_si32( _mm_packus_epi16( x, x ) );
+}
+
+// 'lut_unpremultiply[a]' is '255 * 2^16 / a' rounded, '0' for '0'.
+constexpr std::array <uint32_t, 256> lut_unpremultiply = []() {
+	std::array <uint32_t, 256> lut = {};
+	for ( uint32_t a = 1; a < 256; a++ ) lut[a] = (255u * 65536u + a / 2) / a;
+	return lut;
+}();
+
+// Inverse of 'premultiply()' through reciprocal table. Components over alpha (rounding of blur) are clamped to it,
+// so products fit in 32 bits and results are saturated. Fully transparent pixel becomes zero.
+inline uint32_t unpremultiply( uint32_t p ) {
+	__m128i v = _mm_cvtepu8_epi32( _mm_cvtsi32_si128( p ) );
+	__m128i c = _mm_min_epu32( v, _mm_set1_epi32( p >> 24 ) );
+	__m128i x = _mm_mullo_epi32( c, _mm_set1_epi32( lut_unpremultiply[p >> 24] ) );
+	x = _mm_srli_epi32( _mm_add_epi32( x, _mm_set1_epi32( 1 << 15 ) ), 16 );
+	x = _mm_blend_epi16( x, v, 0xc0 );	// Alpha is kept
+	x = _mm_packus_epi32( x, x );
+	return _mm_cvtsi128_si32( _mm_packus_epi16( x, x ) );
+}
+
+
+// Copies 'src' to 'dst' of the same size and any format, white is kept white.
+// 8-bit 'dst' of one component (A8) gets the first component of 8-bit 'src'.
+inline bool convert( const san::surface & src, san::surface & dst ) {
+	if ( src.width() == dst.width() && src.height() == dst.height() && src.components() == 4 && dst.components() == 1 &&
+		 src.format() == pixel_format::rgba8 && dst.format() == pixel_format::rgba8 )
+	{
+		for ( int y = 0; y < src.height(); y++ ) {
+			const uint8_t * p_src = src.row_ptr( y );
+			uint8_t * p_dst = dst.row_ptr( y );
+			for ( int x = 0; x < src.width(); x++ ) p_dst[x] = p_src[x * 4];
+		}
+		return true;
+	}
+
+	if ( src.width() != dst.width() || src.height() != dst.height() || src.components() != 4 || dst.components() != 4 ) {
+		std::fprintf( stderr, "%s: images must be 4 components of the same size.\n", __FUNCTION__ );
+		return false;
+	}
+
+	bool ok = false;
+	visit( src.format(), [&]( auto src_pixel ) {
+		ok = visit( dst.format(), [&]( auto dst_pixel ) {
+			using SrcT = decltype(src_pixel);
+			using DstT = decltype(dst_pixel);
+			const __m128 scale = _mm_set1_ps( max_value<DstT> / max_value<SrcT> );
+			for ( int y = 0; y < src.height(); y++ ) {
+				const SrcT * p_src = (const SrcT *)src.row_ptr( y );
+				DstT * p_dst = (DstT *)dst.row_ptr( y );
+				for ( int x = 0; x < src.width(); x++ ) store_ps( p_dst + x, _mm_mul_ps( load_ps( p_src + x ), scale ) );
+			}
+		} );
+	} );
+	return ok;
+}
+
+
+// Difference of two images of the same size and format, all components. In units of format, PSNR is relative to white.
+struct error_stats {
+	double	max_abs		= 0;
+	double	mean_abs	= 0;
+	double	psnr_db		= 0;	// Infinity if images are equal
+};
+
+inline error_stats measure_error( const san::surface & a, const san::surface & b ) {
+	error_stats e;
+	if ( a.width() != b.width() || a.height() != b.height() || a.components() != b.components() || a.format() != b.format() ) return e;
+
+	double count = double(a.width()) * a.components() * a.height();
+
+	if ( a.format() == pixel_format::rgba8 ) {
+		uint64_t sum = 0, sum_sq = 0;
+		int max_abs = 0;
+		int n = a.width() * a.components();
+		for ( int y = 0; y < a.height(); y++ ) {
+			const uint8_t * pa = a.row_ptr( y );
+			const uint8_t * pb = b.row_ptr( y );
+			for ( int i = 0; i < n; i++ ) {
+				int d = std::abs( int(pa[i]) - int(pb[i]) );
+				max_abs = std::max( max_abs, d );
+				sum    += d;
+				sum_sq += d * d;
+			}
+		}
+
+		e.max_abs  = max_abs;
+		e.mean_abs = sum / count;
+		e.psnr_db  = sum_sq ? 10. * std::log10( 255. * 255. * count / sum_sq ) : std::numeric_limits<double>::infinity();
+		return e;
+	}
+
+	visit( a.format(), [&]( auto tag ) {
+		using PixelT = decltype(tag);
+		double sum = 0, sum_sq = 0;
+		for ( int y = 0; y < a.height(); y++ ) {
+			const PixelT * pa = (const PixelT *)a.row_ptr( y );
+			const PixelT * pb = (const PixelT *)b.row_ptr( y );
+			for ( int x = 0; x < a.width(); x++ ) {
+				double ca[4], cb[4];
+				unpack( pa[x], ca );
+				unpack( pb[x], cb );
+				for ( int i = 0; i < 4; i++ ) {
+					double d = std::abs( ca[i] - cb[i] );
+					e.max_abs = std::max( e.max_abs, d );
+					sum    += d;
+					sum_sq += d * d;
+				}
+			}
+		}
+
+		double white = max_value<PixelT>;
+		e.mean_abs = sum / count;
+		e.psnr_db  = sum_sq > 0 ? 10. * std::log10( white * white * count / sum_sq ) : std::numeric_limits<double>::infinity();
+	} );
+	return e;
+}
+
+} // namespace san::pixel
@@ -2,13 +2,21 @@
 
 namespace san {
 
+// Storage of components. Pixels of 16-bit formats are always four components (see 'san_pixel.hpp').
+enum class pixel_format : uint8_t {
+	rgba8,		// 8-bit unsigned, 'components' per pixel
+	rgba16,		// 16-bit unsigned
+	rgba16f		// IEEE half-float
+};
+
 class surface {
-	bool		m_managed_outside;
-	int			m_width;
-	int			m_height;
-	int			m_components;	// 3 - RGB/BGR, 4 - RGBA/ARGB/...
-	int			m_stride;
-	uint8_t *	m_data;
+	bool			m_managed_outside;
+	pixel_format	m_format;
+	int				m_width;
+	int				m_height;
+	int				m_components;	// 3 - RGB/BGR, 4 - RGBA/ARGB/...
+	int				m_stride;
+	uint8_t *		m_data;
 
 public:
 	static constexpr size_t alloc_alignment = 64;
@@ -34,22 +42,23 @@ public:
 		return 1 << b;
 	}
 
-	surface( int width, int height, int components )
+	surface( int width, int height, int components, pixel_format format = pixel_format::rgba8 )
 		: m_managed_outside( false )
+		, m_format( format )
 		, m_width( width )
 		, m_height( height )
 		, m_components( components )
-		, m_stride( (m_width * m_components + alloc_alignment - 1) / alloc_alignment * alloc_alignment )
+		, m_stride( (m_width * bytes_per_pixel() + alloc_alignment - 1) / alloc_alignment * alloc_alignment )
 		, m_data( alloc( m_stride * m_height ) )
 	{
+		assert( m_format == pixel_format::rgba8 || m_components == 4 );
 		assert( get_alignment_bytes( (uintptr_t)m_data ) >= alloc_alignment );
 		assert( get_alignment_bytes( m_stride ) >= alloc_alignment );
-		printf( "m_data: %p, alignment: %zu\n", m_data, get_alignment_bytes( (uintptr_t)m_data ) );
-		printf( "m_stride: %4d, alignment: %zu\n", m_stride, get_alignment_bytes( (uintptr_t)m_stride ) );
 	}
 
-	surface( uint8_t * p, int width, int height, int stride, int components )
+	surface( uint8_t * p, int width, int height, int stride, int components, pixel_format format = pixel_format::rgba8 )
 		: m_managed_outside( true )
+		, m_format( format )
 		, m_width( width )
 		, m_height( height )
 		, m_components( components )
@@ -58,6 +67,7 @@ public:
 
 	surface( const surface & other )
 		: m_managed_outside( false )
+		, m_format( other.m_format )
 		, m_width( other.m_width )
 		, m_height(	other.m_height )
 		, m_components(	other.m_components )
@@ -71,6 +81,7 @@ public:
 		if ( this == &other ) return *this;
 		free( m_data );
 		m_managed_outside	= false;
+		m_format			= other.m_format;
 		m_width				= other.m_width;
 		m_height			= other.m_height;
 		m_components		= other.m_components;
@@ -88,14 +99,20 @@ public:
 	int			height()				const { return m_height; }
 	int			stride()				const { return m_stride; }
 	int			components()			const { return m_components; }
+	pixel_format format()				const { return m_format; }
+
+	int bytes_per_pixel() const {
+		return m_format == pixel_format::rgba8 ? m_components : m_components * 2;
+	}
 
 	uint8_t *	ptr()					const { return m_data; }
 	uint8_t *	row_ptr( int y )		const { return ptr() + y * m_stride; }
-	uint8_t *	col_ptr( int x )		const { return ptr() + x * m_components; }
-	uint8_t *	pix_ptr( int x, int y )	const { return row_ptr( y ) + x * m_components; }
+	uint8_t *	col_ptr( int x )		const { return ptr() + x * bytes_per_pixel(); }
+	uint8_t *	pix_ptr( int x, int y )	const { return row_ptr( y ) + x * bytes_per_pixel(); }
 
 	// Swap 2 components
 	void swap_components( uint8_t a, uint8_t b ) {
+		assert( m_format == pixel_format::rgba8 );
 		for ( int y = 0; y < m_height; y++ ) {
 			uint8_t * p = row_ptr( y );
 			for ( int x = 0; x < m_width; x++ ) {
@@ -105,13 +122,15 @@ public:
 		}
 	}
 
+	// Formats must be the same, use 'pixel::convert' otherwise. Only 8-bit images are resized.
 	void blit_to( surface & p_dst ) const {
 		assert( m_components == p_dst.components() );
+		assert( m_format == p_dst.format() );
 
 		if ( m_width  == p_dst.width() &&
 			 m_height == p_dst.height() )
 		{
-			int len = m_width * m_components;
+			int len = m_width * bytes_per_pixel();
 			for ( int y = 0; y < m_height; y++ ) {
 				uint8_t * ps = row_ptr( y );
 				uint8_t * pd = p_dst.row_ptr( y );
@@ -119,6 +138,7 @@ public:
 			}
 		} else {
 			// Resize...
+			assert( m_format == pixel_format::rgba8 );
 			stbir_resize_uint8(
 					m_data, m_width, m_height, m_stride,						// src
 					p_dst.ptr(), p_dst.width(), p_dst.height(), p_dst.stride(),	// dst
@@ -134,9 +154,13 @@ public:
 // Same as 'surface' but doesn't manages memory allocation
 class surface_view : public surface {
 public:
-	surface_view( surface & s ) : surface( s.ptr(), s.width(), s.height(), s.stride(), s.components() ) {}
+	surface_view( surface & s ) : surface( s.ptr(), s.width(), s.height(), s.stride(), s.components(), s.format() ) {}
 	surface_view( std::shared_ptr <surface> & s ) : surface_view( *s ) {}
 
+	// 'w' x 'h' rectangle of 's' at 'x', 'y' (sprite of atlas, thumbnail of sheet...)
+	surface_view( surface & s, int x, int y, int w, int h )
+		: surface( s.pix_ptr( x, y ), w, h, s.stride(), s.components(), s.format() ) {}
+
 	void blit_to( surface_view & p_dst ) const {
 		surface::blit_to( p_dst );
 	}
@@ -155,7 +179,7 @@ public:
 
 	// TODO: create image copy
 	if ( surface::get_alignment_bytes( (uintptr_t)p_image ) < surface::alloc_alignment ) {
-		std::printf( "[WARNING]: stbi_load() image alignment < surface::alloc_alignment (%d)\n", surface::alloc_alignment );
+		std::printf( "[WARNING]: stbi_load() image alignment < surface::alloc_alignment (%zu)\n", surface::alloc_alignment );
 	}
 
 	san::surface * p_surface = nullptr;
@@ -0,0 +1,194 @@
+#pragma once
+
+// Raw 32bpp surface container, which is memory-mapped instead of decoded.
+// Layout: 'raw_header' (64 bytes), then 'height' rows of 'stride' bytes. Pixels are B, G, R, A bytes,
+// i.e. the same as in memory of 'surface' after 'load_image()', so no swizzle is needed.
+// Pixel data offset and stride are multiples of 'surface::alloc_alignment', so mapped surface is aligned as allocated one.
+
+namespace san {
+
+struct raw_header {
+	static constexpr char		magic_value[4]	= { 'S', 'A', 'N', 'R' };
+	static constexpr uint32_t	version_value	= 1;
+	static constexpr uint32_t	format_bgra32	= 1;
+
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	header_size;	// Offset of the first row
+	uint32_t	width;
+	uint32_t	height;
+	uint32_t	stride;			// In bytes
+	uint32_t	format;
+	uint8_t		reserved[36];
+
+	// Stride of 'width' 32bpp pixels padded to alignment
+	static uint32_t default_stride( uint32_t width ) {
+		return uint32_t((size_t(width) * 4 + surface::alloc_alignment - 1) / surface::alloc_alignment * surface::alloc_alignment);
+	}
+
+	bool valid( size_t file_size ) const {
+		return	std::memcmp( magic, magic_value, sizeof( magic ) ) == 0 &&
+				version == version_value &&
+				format  == format_bgra32 &&
+				header_size >= sizeof( raw_header ) && header_size % surface::alloc_alignment == 0 &&
+				width > 0 && height > 0 && width <= INT32_MAX / 4 && height <= INT32_MAX &&
+				stride >= width * 4 && stride % surface::alloc_alignment == 0 && stride <= INT32_MAX &&
+				file_size >= header_size + uint64_t(stride) * height;
+	}
+}; // struct raw_header
+
+static_assert( sizeof( raw_header ) == surface::alloc_alignment );
+
+
+// Maps whole file into memory.
+// Writable mapping writes through to the file, read-only one is copy-on-write, so it still can be modified in memory.
+class file_mapping {
+	uint8_t *	m_ptr	= nullptr;
+	size_t		m_size	= 0;
+#if defined( SAN_PLATFORM_WINDOWS )
+	HANDLE		m_file		= INVALID_HANDLE_VALUE;
+	HANDLE		m_mapping	= nullptr;
+#else
+	int			m_fd		= -1;
+#endif
+
+	bool map( const char * filename, bool writable, size_t create_size ) {
+#if defined( SAN_PLATFORM_WINDOWS )
+		m_file = CreateFileA( filename, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+							  create_size ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+		if ( m_file == INVALID_HANDLE_VALUE ) return false;
+
+		if ( create_size ) {
+			m_size = create_size;
+		} else {
+			LARGE_INTEGER size;
+			if ( !GetFileSizeEx( m_file, &size ) || !size.QuadPart ) return false;
+			m_size = size_t(size.QuadPart);
+		}
+
+		// Mapping of requested size extends created file.
+		m_mapping = CreateFileMappingA( m_file, nullptr, writable ? PAGE_READWRITE : PAGE_WRITECOPY,
+										DWORD(uint64_t(m_size) >> 32), DWORD(m_size), nullptr );
+		if ( !m_mapping ) return false;
+
+		m_ptr = (uint8_t *)MapViewOfFile( m_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, m_size );
+#else
+		m_fd = ::open( filename, writable ? (create_size ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR) : O_RDONLY, 0644 );
+		if ( m_fd < 0 ) return false;
+
+		if ( create_size ) {
+			if ( ::ftruncate( m_fd, off_t(create_size) ) != 0 ) return false;
+			m_size = create_size;
+		} else {
+			struct stat st;
+			if ( ::fstat( m_fd, &st ) != 0 || !st.st_size ) return false;
+			m_size = size_t(st.st_size);
+		}
+
+		int flags = writable ? MAP_SHARED : MAP_PRIVATE;
+ #if defined( MAP_POPULATE )
+		flags |= MAP_POPULATE;	// Whole image will be touched anyway, so avoid page faults one by one
+ #endif
+		void * p = ::mmap( nullptr, m_size, PROT_READ | PROT_WRITE, flags, m_fd, 0 );
+		if ( p != MAP_FAILED ) m_ptr = (uint8_t *)p;
+#endif
+		return m_ptr != nullptr;
+	}
+
+public:
+	// 'create_size' > 0 - create new (or truncate existing) file of that size.
+	file_mapping( const char * filename, bool writable, size_t create_size = 0 ) {
+		if ( !map( filename, writable || create_size, create_size ) ) {
+			std::fprintf( stderr, "Couldn't map file '%s'.\n", filename );
+		}
+	}
+
+	file_mapping( const file_mapping & ) = delete;
+	file_mapping & operator = ( const file_mapping & ) = delete;
+
+	~file_mapping() {
+#if defined( SAN_PLATFORM_WINDOWS )
+		if ( m_ptr ) UnmapViewOfFile( m_ptr );
+		if ( m_mapping ) CloseHandle( m_mapping );
+		if ( m_file != INVALID_HANDLE_VALUE ) CloseHandle( m_file );
+#else
+		if ( m_ptr ) ::munmap( m_ptr, m_size );
+		if ( m_fd >= 0 ) ::close( m_fd );
+#endif
+	}
+
+	explicit operator bool () const { return m_ptr != nullptr; }
+
+	uint8_t *	ptr()	const { return m_ptr; }
+	size_t		size()	const { return m_size; }
+}; // class file_mapping
+
+
+namespace detail {
+
+// Surface over pixels of mapped file. Mapping lives as long as the surface.
+[[nodiscard]] inline std::shared_ptr <san::surface> make_mapped_surface( file_mapping * p_map ) {
+	san::surface * p_surface = nullptr;
+
+	if ( p_map && *p_map ) {
+		const raw_header * p_hdr = (const raw_header *)p_map->ptr();
+		if ( p_map->size() >= sizeof( raw_header ) && p_hdr->valid( p_map->size() ) ) {
+			p_surface = new (std::nothrow) san::surface( p_map->ptr() + p_hdr->header_size, p_hdr->width, p_hdr->height, p_hdr->stride, 4 );
+		} else {
+			std::fprintf( stderr, "Bad raw image header.\n" );
+		}
+	}
+
+	if ( !p_surface ) {
+		delete p_map;
+		return nullptr;
+	}
+
+	return std::shared_ptr<san::surface>( p_surface, [p_map]( san::surface * p_surface ) {
+			delete p_surface;
+			delete p_map;
+		} );
+}
+
+} // namespace detail
+
+
+// Maps existing raw image. Changes of writable surface go right to the file.
+[[nodiscard]] inline std::shared_ptr <san::surface> map_raw_image( const char * filename, bool writable = false ) {
+	return detail::make_mapped_surface( new (std::nothrow) file_mapping( filename, writable ) );
+}
+
+// Creates raw image file of given size and maps it for writing.
+[[nodiscard]] inline std::shared_ptr <san::surface> create_raw_image( const char * filename, int width, int height ) {
+	if ( width < 1 || height < 1 ) return nullptr;
+
+	raw_header hdr = {};
+	std::memcpy( hdr.magic, raw_header::magic_value, sizeof( hdr.magic ) );
+	hdr.version		= raw_header::version_value;
+	hdr.header_size	= sizeof( raw_header );
+	hdr.width		= uint32_t(width);
+	hdr.height		= uint32_t(height);
+	hdr.stride		= raw_header::default_stride( hdr.width );
+	hdr.format		= raw_header::format_bgra32;
+
+	file_mapping * p_map = new (std::nothrow) file_mapping( filename, true, hdr.header_size + size_t(hdr.stride) * hdr.height );
+	if ( p_map && *p_map ) {
+		std::memcpy( p_map->ptr(), &hdr, sizeof( hdr ) );
+	}
+	return detail::make_mapped_surface( p_map );
+}
+
+// Stores four component surface as raw image, 16-bit and half-float pixels are converted to 32bpp ones.
+inline bool save_raw_image( const san::surface & s, const char * filename ) {
+	if ( s.components() != 4 ) return false;
+
+	std::shared_ptr <san::surface> p_raw = create_raw_image( filename, s.width(), s.height() );
+	if ( !p_raw ) return false;
+
+	if ( s.format() != san::pixel_format::rgba8 ) return san::pixel::convert( s, *p_raw );
+
+	s.blit_to( p_raw );
+	return true;
+}
+
+} // namespace san
@@ -0,0 +1,92 @@
+#pragma once
+
+namespace san {
+
+// Transposes 4x4 block of 32-bit pixels. Strides are in pixels.
+inline void transpose_4x4( const uint32_t * p_src, int src_stride, uint32_t * p_dst, int dst_stride ) {
+	__m128i r0 = _mm_loadu_si128( (const __m128i *)(p_src                 ) );	// a0 a1 a2 a3
+	__m128i r1 = _mm_loadu_si128( (const __m128i *)(p_src +     src_stride) );	// b0 b1 b2 b3
+	__m128i r2 = _mm_loadu_si128( (const __m128i *)(p_src + 2 * src_stride) );	// c0 c1 c2 c3
+	__m128i r3 = _mm_loadu_si128( (const __m128i *)(p_src + 3 * src_stride) );	// d0 d1 d2 d3
+
+	__m128i t0 = _mm_unpacklo_epi32( r0, r1 );	// a0 b0 a1 b1
+	__m128i t1 = _mm_unpacklo_epi32( r2, r3 );	// c0 d0 c1 d1
+	__m128i t2 = _mm_unpackhi_epi32( r0, r1 );	// a2 b2 a3 b3
+	__m128i t3 = _mm_unpackhi_epi32( r2, r3 );	// c2 d2 c3 d3
+
+	_mm_storeu_si128( (__m128i *)(p_dst                 ), _mm_unpacklo_epi64( t0, t1 ) );	// a0 b0 c0 d0
+	_mm_storeu_si128( (__m128i *)(p_dst +     dst_stride), _mm_unpackhi_epi64( t0, t1 ) );	// a1 b1 c1 d1
+	_mm_storeu_si128( (__m128i *)(p_dst + 2 * dst_stride), _mm_unpacklo_epi64( t2, t3 ) );	// a2 b2 c2 d2
+	_mm_storeu_si128( (__m128i *)(p_dst + 3 * dst_stride), _mm_unpackhi_epi64( t2, t3 ) );	// a3 b3 c3 d3
+}
+
+// Transposes 'width' x 'height' block of 32-bit pixels: p_dst[x * dst_stride + y] = p_src[y * src_stride + x].
+// 4x4 SIMD blocks inside, scalar at right and bottom edges.
+inline void transpose( const uint32_t * p_src, int src_stride, uint32_t * p_dst, int dst_stride, int width, int height ) {
+	int w4 = width  & ~3;
+	int h4 = height & ~3;
+
+	for ( int y = 0; y < h4; y += 4 ) {
+		for ( int x = 0; x < w4; x += 4 ) {
+			transpose_4x4( p_src + y * src_stride + x, src_stride, p_dst + x * dst_stride + y, dst_stride );
+		}
+		for ( int x = w4; x < width; x++ ) {
+			for ( int i = y; i < y + 4; i++ ) p_dst[x * dst_stride + i] = p_src[i * src_stride + x];
+		}
+	}
+
+	for ( int y = h4; y < height; y++ ) {
+		for ( int x = 0; x < width; x++ ) p_dst[x * dst_stride + y] = p_src[y * src_stride + x];
+	}
+}
+
+// Transposes 16x16 block of 8-bit pixels. Strides are in pixels.
+// Four rounds of interleaving (8, 16, 32 and 64 bits) of rows pairs; after them, vector 'i' holds source column
+// with bits of 'i' reversed.
+inline void transpose_16x16( const uint8_t * p_src, int src_stride, uint8_t * p_dst, int dst_stride ) {
+	__m128i a[16], b[16];
+	for ( int i = 0; i < 16; i++ ) a[i] = _mm_loadu_si128( (const __m128i *)(p_src + i * src_stride) );
+
+	for ( int i = 0; i < 8; i++ ) {
+		b[i]     = _mm_unpacklo_epi8( a[2 * i], a[2 * i + 1] );
+		b[i + 8] = _mm_unpackhi_epi8( a[2 * i], a[2 * i + 1] );
+	}
+	for ( int i = 0; i < 8; i++ ) {
+		a[i]     = _mm_unpacklo_epi16( b[2 * i], b[2 * i + 1] );
+		a[i + 8] = _mm_unpackhi_epi16( b[2 * i], b[2 * i + 1] );
+	}
+	for ( int i = 0; i < 8; i++ ) {
+		b[i]     = _mm_unpacklo_epi32( a[2 * i], a[2 * i + 1] );
+		b[i + 8] = _mm_unpackhi_epi32( a[2 * i], a[2 * i + 1] );
+	}
+	for ( int i = 0; i < 8; i++ ) {
+		a[i]     = _mm_unpacklo_epi64( b[2 * i], b[2 * i + 1] );
+		a[i + 8] = _mm_unpackhi_epi64( b[2 * i], b[2 * i + 1] );
+	}
+
+	for ( int i = 0; i < 16; i++ ) {
+		int col = ((i & 1) << 3) | ((i & 2) << 1) | ((i & 4) >> 1) | ((i & 8) >> 3);
+		_mm_storeu_si128( (__m128i *)(p_dst + col * dst_stride), a[i] );
+	}
+}
+
+// Transposes 'width' x 'height' block of 8-bit pixels (see above). 16x16 SIMD blocks inside, scalar at edges.
+inline void transpose( const uint8_t * p_src, int src_stride, uint8_t * p_dst, int dst_stride, int width, int height ) {
+	int w16 = width  & ~15;
+	int h16 = height & ~15;
+
+	for ( int y = 0; y < h16; y += 16 ) {
+		for ( int x = 0; x < w16; x += 16 ) {
+			transpose_16x16( p_src + y * src_stride + x, src_stride, p_dst + x * dst_stride + y, dst_stride );
+		}
+		for ( int x = w16; x < width; x++ ) {
+			for ( int i = y; i < y + 16; i++ ) p_dst[x * dst_stride + i] = p_src[i * src_stride + x];
+		}
+	}
+
+	for ( int y = h16; y < height; y++ ) {
+		for ( int x = 0; x < width; x++ ) p_dst[x * dst_stride + y] = p_src[y * src_stride + x];
+	}
+}
+
+} // namespace san